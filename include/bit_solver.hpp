@@ -0,0 +1,35 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "solver_stats.hpp"
+#include "board.hpp"
+
+// Backtracking solver on row / column / box bitmasks. Always fills the cell
+// with the fewest candidates next, which makes it orders of magnitude faster
+// than Sudoku::solveGrid on hard grids. Digits are tried in ascending order,
+// so results are deterministic.
+class BitSolver {
+public:
+    explicit BitSolver(const Board& grid);
+    // false if the givens already conflict
+    bool valid() const { return consistent; }
+    // first solution into out, false if there is none
+    bool solve(Board& out);
+    // number of solutions, stopping once `limit` have been found
+    int count(int limit = 2);
+    // rule out digit for an empty cell, e.g. to ask "is there a solution
+    // other than the known one?" after removing a clue
+    void forbid(int row, int col, int digit) { forbidden[row * 9 + col] |= 1 << (digit - 1); }
+
+    SolverStats* stats = nullptr;
+
+private:
+    Board board;
+    std::array<uint16_t, 9> rows{}, cols{}, boxes{};
+    std::array<uint16_t, 81> forbidden{};
+    std::array<uint8_t, 81> empty{};
+    int emptyCount = 0;
+    bool consistent = true;
+
+    int search(int depth, int limit, int found, Board* out);
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+// candidate / used-digit masks have bit d - 1 set for digit d
+constexpr uint16_t allDigits = 0x1FF;
+
+// box 0..8 of cell idx, boxes numbered row-major like the cells
+constexpr int boxOf(int idx) {
+    return (idx / 27) * 3 + (idx % 9) / 3;
+}
+
+// A 9x9 grid stored as one byte per cell (0 = empty), row-major, so a whole
+// board is 81 contiguous bytes. board[row][col] reads and writes cells just
+// like the int[9][9] arrays it replaces.
+struct Board {
+    std::array<uint8_t, 81> cells{};
+
+    uint8_t* operator[](int row) { return cells.data() + row * 9; }
+    const uint8_t* operator[](int row) const { return cells.data() + row * 9; }
+    bool operator==(const Board&) const = default;
+
+    // 9-bit mask of the digits not yet used by the cell's row, column and box
+    uint16_t candidates(int row, int col) const {
+        uint16_t used = 0;
+        int boxRow = row - row % 3, boxCol = col - col % 3;
+        for (int i = 0; i < 9; i++) {
+            used |= bit((*this)[row][i]) | bit((*this)[i][col]) | bit((*this)[boxRow + i / 3][boxCol + i % 3]);
+        }
+        return allDigits & ~used;
+    }
+
+    // FNV-1a over the cells, e.g. for cache keys
+    uint64_t hash() const {
+        uint64_t h = 0xcbf29ce484222325;
+        for (uint8_t value : cells) {
+            h = (h ^ value) * 0x100000001b3;
+        }
+        return h;
+    }
+
+    // 81 characters, '0' for empty cells
+    std::string str() const {
+        std::string s(81, '0');
+        for (int i = 0; i < 81; i++) {
+            s[i] = static_cast<char>('0' + cells[i]);
+        }
+        return s;
+    }
+
+private:
+    static uint16_t bit(uint8_t value) { return value ? 1 << (value - 1) : 0; }
+};
+
+// Two cells per byte (41 bytes per grid) for holding very large numbers of
+// boards, e.g. puzzle pools and caches. Unpack to a Board to work on it.
+struct PackedBoard {
+    std::array<uint8_t, 41> nibbles{};
+
+    PackedBoard() = default;
+    explicit PackedBoard(const Board& board) {
+        for (int i = 0; i < 81; i++) {
+            nibbles[i / 2] |= board.cells[i] << ((i % 2) * 4);
+        }
+    }
+
+    Board unpack() const {
+        Board board;
+        for (int i = 0; i < 81; i++) {
+            board.cells[i] = (nibbles[i / 2] >> ((i % 2) * 4)) & 0xF;
+        }
+        return board;
+    }
+
+    bool operator==(const PackedBoard&) const = default;
+};
+
+// peerCells[idx] lists the 20 cells that share a row, column or box with cell idx
+constexpr std::array<std::array<uint8_t, 20>, 81> peerCells = [] {
+    std::array<std::array<uint8_t, 20>, 81> peers{};
+    for (int idx = 0; idx < 81; idx++) {
+        int row = idx / 9, col = idx % 9, n = 0;
+        for (int other = 0; other < 81; other++) {
+            int r = other / 9, c = other % 9;
+            bool peer = r == row || c == col || (r / 3 == row / 3 && c / 3 == col / 3);
+            if (peer && other != idx) {
+                peers[idx][n++] = other;
+            }
+        }
+    }
+    return peers;
+}();
+
+static_assert(sizeof(Board) == 81);
+static_assert(sizeof(PackedBoard) == 41);
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+// Non-interactive subcommands: `sudokurse <command> [args...]`.
+// Each returns the process exit code.
+int run_command(int argc, char* argv[]);
+
+int export_book(int argc, char* argv[]);
+int record_game(int argc, char* argv[]);
+int replay_session(int argc, char* argv[]);
+int analyze_log(int argc, char* argv[]);
+int calibrate(int argc, char* argv[]);
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+enum class Difficulty {
+    Easy,
+    Medium,
+    Hard,
+    Master
+};
+
+constexpr int difficultyCount = 4;
+
+// Highest difficultyLevel score still counted as Easy, Medium and Hard;
+// anything above the last is Master. The defaults line up with the
+// LogicSolver technique tiers; `sudokurse calibrate` measures better ones.
+struct DifficultyThresholds {
+    std::array<int, difficultyCount - 1> upper{400, 800, 1100};
+};
+
+std::string difficulty_str(Difficulty d);
+// inverse of difficulty_str, false if name is not a difficulty
+bool parse_difficulty(const std::string& name, Difficulty& d);
+// band of a Sudoku::difficultyLevel score
+Difficulty classify_difficulty(int difficultyLevel, const DifficultyThresholds& thresholds);
+
+// `$XDG_CONFIG_HOME/sudokurse/difficulty.conf` or `~/.config/sudokurse/difficulty.conf`
+std::filesystem::path default_thresholds_path();
+// plain `easy=N` / `medium=N` / `hard=N` lines, `#` starts a comment
+std::optional<DifficultyThresholds> read_thresholds(const std::filesystem::path& path);
+bool write_thresholds(const std::filesystem::path& path, const DifficultyThresholds& thresholds, const std::string& comment = "");
+// the default config file if there is a valid one, otherwise the defaults
+DifficultyThresholds load_difficulty_thresholds();
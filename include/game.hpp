@@ -2,6 +2,10 @@
 #include <array>
 #include <string>
 #include "stopwatch.hpp"
+#include "savegame.hpp"
+#include "session_log.hpp"
+#include "board.hpp"
+#include "difficulty.hpp"
 #include <memory>
 
 namespace GameConstants {
@@ -16,49 +20,57 @@ namespace GameConstants {
     constexpr int greenColorPair = 5;
     constexpr int offsetY = 1;
     constexpr int offsetX = 1;
+    // cap on how long a new game may take to generate; clue removal always
+    // gets at least generationGrace so the kept puzzle is never the bare grid
+    constexpr auto generationTimeLimit = std::chrono::seconds(2);
+    constexpr auto generationGrace = std::chrono::milliseconds(250);
 }
 
-enum class Difficulty {
-    Easy,
-    Medium,
-    Hard,
-    Master
-};
-
-std::string difficulty_str(Difficulty d);
+struct GenProgress;
 
 class Game {
 public:
     Game();
     ~Game();
+    // log every key and board change of this session to `path`
+    bool record_to(const std::filesystem::path& path);
     void start();
 private:
     int cursorY = 0, cursorX = 0;
     Difficulty difficulty = Difficulty::Easy;
-    std::array<std::array<int, 9>, 9> game{};
-    std::array<std::array<int, 9>, 9> penciled1{};
-    std::array<std::array<int, 9>, 9> penciled2{};
-    std::array<std::array<int, 9>, 9> initialState{};
-    std::array<std::array<int, 9>, 9> solution{};
+    DifficultyThresholds thresholds;    // read from the config file in start()
+    Board game;
+    // pencil marks, bit d-1 set when digit d is penciled in
+    std::array<std::array<uint16_t, 9>, 9> pencil{};
+    Board initialState;
+    Board solution;
     std::string errorText;
     std::string successText;
     std::unique_ptr<Stopwatch> stopwatch;
-    bool isPencil2 = false;
+    std::unique_ptr<Autosaver> autosaver;
+    std::unique_ptr<SessionRecorder> recorder;
+    bool boardChanged = false;
+    bool quitRequested = false;
     void reset_game();
+    SaveState snapshot() const;
+    void restore(const SaveState& state);
     void update_loop();
     int at(int row, int col) const;
     void set(int row, int col, int value, bool isPenciled = false);
     void set_at_cursor(int value, bool isPenciled = false);
     void clear(int row, int col, bool isPenciled = false);
     void clear_at_cursor(bool isPenciled = false);
+    void fill_pencil_marks();
     int at_cursor() const;
     void translate_cursor(int dRow, int dCol);
     void move_cursor(int row, int col);
     void try_solve();
     void auto_solve();
     void draw_cell(int row, int col) const;
+    void draw_pencil_marks() const;
     void init_view() const;
     void draw_grid() const;
     void refresh_view();
     void draw_help() const;
+    void draw_generation_progress(const GenProgress& progress) const;
 };
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+// Minimal lazy generator for C++20 coroutines (std::generator is C++23).
+// The coroutine yields references to objects it owns; each reference is valid
+// until the generator is resumed again. The frame is allocated once when the
+// coroutine is created -- yielding never allocates.
+//
+//   for (const Board& solution : enumerate_solutions(puzzle)) { ... }
+//   or: while (const Board* s = gen.next()) { ... }
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        const T* current = nullptr;
+
+        Generator get_return_object() { return Generator(handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const T& value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { throw; }
+    };
+
+    using handle = std::coroutine_handle<promise_type>;
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(Generator* gen) : gen(gen) {}
+        const T& operator*() const { return *gen->coroutine.promise().current; }
+        const T* operator->() const { return gen->coroutine.promise().current; }
+        iterator& operator++() {
+            if (!gen->next()) {
+                gen = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return gen == nullptr; }
+
+    private:
+        Generator* gen = nullptr;
+    };
+
+    Generator(Generator&& other) noexcept : coroutine(std::exchange(other.coroutine, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            coroutine = std::exchange(other.coroutine, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() { destroy(); }
+
+    // resumes until the next value; nullptr once the coroutine has finished
+    const T* next() {
+        if (!coroutine || coroutine.done()) {
+            return nullptr;
+        }
+        coroutine.resume();
+        return coroutine.done() ? nullptr : coroutine.promise().current;
+    }
+
+    iterator begin() { return next() ? iterator(this) : iterator(); }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    explicit Generator(handle h) : coroutine(h) {}
+    void destroy() {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+
+    handle coroutine;
+};
\ No newline at end of file
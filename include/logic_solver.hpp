@@ -0,0 +1,79 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "solver_stats.hpp"
+#include "board.hpp"
+
+// Human solving techniques, in the order the logic solver tries them.
+enum class Technique : uint8_t {
+    HiddenSingle,
+    NakedSingle,
+    Pointing,
+    Claiming,
+    NakedPair,
+    HiddenPair,
+    NakedTriple,
+    HiddenTriple,
+    XWing,
+    Swordfish,
+    Count
+};
+
+constexpr int techniqueCount = static_cast<int>(Technique::Count);
+
+const char* technique_str(Technique t);
+
+struct LogicResult {
+    bool solved = false;
+    bool contradiction = false;     // the grid has no solution
+    int emptyCells = 0;             // empty cells before solving
+    int remaining = 0;              // empty cells the techniques could not fill
+    std::array<int, techniqueCount> uses{};
+    int hardest = -1;               // index of the hardest technique used, -1 if none
+    int score = 0;
+
+    int count(Technique t) const { return uses[static_cast<int>(t)]; }
+};
+
+// Solves a grid the way a person would: candidates are kept as 9-bit masks and
+// the techniques above are applied in order, always restarting from the
+// simplest one after any progress. No guessing is done, so a grid that needs
+// trial and error is left partially solved.
+// If stats is given, each pass over the technique list counts as a node,
+// each technique attempt as a candidate check, and each placement or
+// elimination as a propagation step.
+class LogicSolver {
+public:
+    explicit LogicSolver(const Board& grid, SolverStats* stats = nullptr);
+    LogicResult solve();
+    int cell(int row, int col) const { return board[row][col]; }
+
+private:
+    Board board;
+    std::array<uint16_t, 81> candidates{};
+    LogicResult result;
+    SolverStats* stats;
+    bool broken = false;
+
+    void place(int idx, int digit);
+    bool eliminate(int idx, uint16_t mask);
+    bool apply(Technique t);
+    bool naked_single();
+    bool hidden_single();
+    bool pointing();
+    bool claiming();
+    bool naked_subset(int size);
+    bool hidden_subset(int size);
+    bool fish(int size);
+};
+
+// Changes whenever a grid's score can change (weights, tiers, techniques),
+// so stored scores such as ResultCache files can tell they are stale.
+constexpr uint32_t logicScoreVersion = 2;
+
+// Difficulty score from the techniques a grid needed, lined up with the
+// default Easy / Medium / Hard / Master cut-offs (400 / 800 / 1100):
+// <= 400 hidden singles only, <= 800 naked singles and locked candidates,
+// 801-900 pairs, triples and fish. Grids the techniques cannot finish score
+// 900 + 6 per cell left, so those that only need a late guess are still Hard.
+int logic_difficulty_score(const LogicResult& result);
\ No newline at end of file
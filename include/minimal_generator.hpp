@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "board.hpp"
+#include "sudoku.hpp"
+
+// Clue patterns a minimal puzzle can be asked to keep.
+enum class Symmetry {
+    None,
+    Rotational,     // 180 degree turn
+    Diagonal,       // mirror in the main diagonal
+    Quarter         // 90 degree turn
+};
+
+struct MinimalOptions {
+    int targetClues = 0;            // keep searching until a puzzle has at most this many clues (0 = any)
+    Symmetry symmetry = Symmetry::None;
+    int threads = 0;                // 0 = one per hardware thread
+    int attempts = 0;               // removal orders to try; 0 = 4096 with a target, else 1024 with
+                                    // a symmetry, else one per thread
+    uint64_t seed = 0;              // 0 = random
+};
+
+struct MinimalResult {
+    Board puzzle;
+    int clues = 81;
+    bool minimal = false;           // removing any single clue breaks uniqueness
+    bool orbitMinimal = false;      // removing any orbit of clues under the symmetry breaks
+                                    // uniqueness (same as minimal without a symmetry)
+    bool symmetric = false;         // the clue pattern has the requested symmetry
+    long long attempts = 0;
+    GenStatus status = GenStatus::Complete;
+};
+
+// Searches many random removal orders of `solution` in parallel and returns
+// the best puzzle: symmetric first, then minimal, then orbit-minimal, then
+// fewest clues. With a symmetry, clues only ever come out a whole orbit at a
+// time, so completed attempts keep the pattern and are orbit-minimal; only
+// a few percent are also minimal, hence the larger default number of
+// attempts. The status is Complete only
+// for a puzzle that is minimal and symmetric (and within targetClues).
+// Uniqueness after removing one clue is checked by looking for any solution
+// that differs from `solution` in that cell, which is much cheaper than
+// counting.
+// The budget's cancel token and deadline are honoured (returning the best
+// puzzle so far); maxNodes is ignored. onProgress is only ever called on
+// the calling thread, with cluesRemoved of the best puzzle so far and
+// positionsTried = attempts finished.
+MinimalResult generate_minimal(const Board& solution, const MinimalOptions& options, const GenBudget& budget = GenBudget());
+
+// true if puzzle has exactly one solution and every clue is needed for that
+bool is_minimal(const Board& puzzle);
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+#include "board.hpp"
+
+enum class BookFormat {
+    Svg,    // one SVG document, pages stacked top to bottom
+    Text    // 9 lines per grid, pages separated by form feeds
+};
+
+struct BookOptions {
+    BookFormat format = BookFormat::Svg;
+    int perPage = 6;
+    int columns = 2;                // SVG only
+    bool solutions = false;         // follow each page of puzzles with a page of their solutions
+    std::string templatePath = "";  // directory holding svgHead.txt; built-in grid if missing
+    int expectedPuzzles = 0;        // SVG only: lets the document height be written up front
+};
+
+// Streams any number of puzzles into a printable book. Templates are loaded
+// once, each page is formatted into one buffer and handed to the stream with a
+// single write, so exporting thousands of puzzles is dominated by generation,
+// not I/O. Only the current page's solutions are held in memory.
+class PuzzleBook {
+public:
+    PuzzleBook(std::ostream& out, BookOptions options);
+    ~PuzzleBook();  // calls finish()
+
+    void add(const Board& puzzle, int difficultyLevel, const Board& solution = Board());
+    // writes the last (possibly partial) page and closes the document
+    void finish();
+    int pages() const { return pageCount; }
+
+private:
+    struct Entry {
+        Board puzzle;
+        Board solution;
+        int difficultyLevel;
+    };
+
+    std::ostream& out;
+    BookOptions options;
+    std::string gridBody;           // SVG drawing of an empty grid, shared by every puzzle
+    std::string buffer;
+    std::vector<Entry> page;
+    int puzzleCount = 0;
+    int pageCount = 0;
+    bool started = false;
+    bool finished = false;
+    std::streampos heightPos = -1;
+
+    void flush_page();
+    int page_height() const;
+    void write_svg_header();
+    void write_svg_page(bool solutions);
+    void write_text_page(bool solutions);
+};
\ No newline at end of file
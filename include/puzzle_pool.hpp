@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "board.hpp"
+#include "difficulty.hpp"
+#include "sudoku.hpp"
+
+namespace PoolConstants {
+    // generated puzzles in a row that landed in other bands before a band
+    // counts as unreachable (e.g. with calibrated thresholds that leave it empty)
+    constexpr int giveUpAfter = 256;
+}
+
+struct PooledPuzzle {
+    PackedBoard puzzle;
+    PackedBoard solution;
+    int difficultyLevel = 0;
+};
+
+// Keeps up to `capacity` ready puzzles per Difficulty, refilled by
+// background generator threads. Generators sleep once every pool is full or
+// has gone giveUpAfter puzzles without receiving one, and wake as soon as a
+// puzzle is drawn or an empty band is asked for, which also gives that band
+// another giveUpAfter tries. Puzzles are banded with the thresholds given
+// at construction and kept packed (41 bytes per board).
+class PuzzlePool {
+public:
+    PuzzlePool(size_t capacity, int threads, const DifficultyThresholds& thresholds);
+    ~PuzzlePool();
+
+    // non-blocking; false if no puzzle of that difficulty is ready yet
+    bool take(Difficulty d, PooledPuzzle& out);
+    size_t size(Difficulty d) const;
+    // eventfd that turns readable whenever a puzzle is added, for event loops
+    int notify_fd() const { return eventFd; }
+    void drain_notifications();
+
+private:
+    void generate(uint64_t seed);
+    bool wants_more() const;
+
+    size_t capacity;
+    DifficultyThresholds thresholds;
+    mutable std::mutex mutex;
+    std::condition_variable space;
+    std::array<std::deque<PooledPuzzle>, difficultyCount> pools;
+    std::array<int, difficultyCount> misses{};     // puzzles generated since the band last got one
+    CancelToken stop;
+    int eventFd;
+    std::vector<std::thread> workers;
+};
\ No newline at end of file
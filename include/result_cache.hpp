@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include "board.hpp"
+
+namespace CacheConstants {
+    constexpr uint32_t magic = 0x43445553;  // "SUDC"
+    constexpr uint16_t version = 2;
+    constexpr int shards = 16;
+}
+
+// What the cache remembers about a puzzle: its first solution (BitSolver
+// order, empty if there is none), how many solutions it has (capped at 2)
+// and its logic difficulty score.
+struct CachedResult {
+    Board solution;
+    int solutions = 0;
+    int difficultyLevel = 0;
+};
+
+struct ResultCacheStats {
+    long long hits = 0;         // answered from memory
+    long long diskHits = 0;     // answered from the file
+    long long misses = 0;
+    long long appends = 0;      // records written to the file by this process
+    long long records = 0;      // records in the file
+};
+
+// Solve / count / grade results keyed by Board::hash(). Recently used
+// results live in a sharded in-memory LRU; every result is also appended to
+// a memory-mapped file, so they survive restarts and anything evicted from
+// memory is still a lookup away. Each entry keeps the puzzle itself, so a
+// hash collision is just a miss. A file written under another
+// logicScoreVersion is started over, so old scores are never served.
+//
+// Any number of threads may use one cache. Only one process can write a
+// cache file; a second one opening it gets a memory-only cache.
+class ResultCache {
+public:
+    // empty path: memory only
+    explicit ResultCache(const std::filesystem::path& path = {}, size_t capacity = 1 << 16);
+    ~ResultCache();
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // cached result, computing and storing it on a miss
+    CachedResult get(const Board& puzzle);
+    // computes and stores the result without looking it up, for a caller
+    // that has just had find() miss
+    CachedResult compute(const Board& puzzle);
+    std::optional<CachedResult> find(const Board& puzzle);
+    // store a result that is already known, e.g. for a freshly generated puzzle
+    void insert(const Board& puzzle, const CachedResult& result);
+
+    bool persistent() const { return fd >= 0; }
+    ResultCacheStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        PackedBoard puzzle;
+        CachedResult result;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> entries;   // most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    };
+
+    std::optional<CachedResult> find_memory(uint64_t hash, const PackedBoard& packed);
+    std::optional<CachedResult> find_disk(uint64_t hash, const PackedBoard& packed);
+    void remember(uint64_t hash, const PackedBoard& packed, const CachedResult& result);
+    void append(uint64_t hash, const PackedBoard& packed, const CachedResult& result);
+    bool open_file(const std::filesystem::path& path);
+    void remap();
+
+    size_t shardCapacity;
+    std::array<Shard, CacheConstants::shards> shards;
+
+    int fd = -1;
+    mutable std::shared_mutex diskMutex;
+    const uint8_t* mapped = nullptr;
+    size_t mappedSize = 0;
+    uint64_t fileSize = 0;
+    std::unordered_map<uint64_t, uint64_t> diskIndex;   // hash -> record offset
+
+    std::atomic<long long> hits{0}, diskHits{0}, misses{0}, appends{0};
+};
+
+// `$XDG_CACHE_HOME/sudokurse/results.cache` or `~/.cache/sudokurse/results.cache`
+std::filesystem::path default_cache_path();
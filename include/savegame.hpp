@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "board.hpp"
+
+namespace SaveConstants {
+    constexpr uint32_t magic = 0x4b445553;  // "SUDK"
+    constexpr uint16_t version = 2;
+    constexpr auto debounce = std::chrono::milliseconds(500);
+}
+
+// Fixed-size binary snapshot of a game in progress. Every board is a Board
+// (81 row-major bytes) and pencil marks are one 16-bit mask per cell, so the
+// whole snapshot is a few hundred bytes and can be written / read with a
+// single call.
+struct SaveState {
+    uint32_t magic = SaveConstants::magic;
+    uint16_t version = SaveConstants::version;
+    uint8_t difficulty = 0;
+    uint8_t reserved = 0;
+    uint32_t elapsedSeconds = 0;
+    uint8_t cursorY = 0;
+    uint8_t cursorX = 0;
+    std::array<uint16_t, 81> pencil{};  // 9-bit pencil mark masks, row-major
+    Board game;
+    Board initialState;
+    Board solution;
+};
+static_assert(std::is_trivially_copyable_v<SaveState>);
+
+// directory used for the save file (and any other per-user state)
+std::filesystem::path state_dir();
+std::filesystem::path default_save_path();
+
+// write to a temporary file and rename it over `path`, so a crash mid-write
+// never leaves a truncated save behind
+bool write_save(const std::filesystem::path& path, const SaveState& state);
+std::optional<SaveState> read_save(const std::filesystem::path& path);
+
+// Writes snapshots on a background thread. Calls to schedule() only copy the
+// snapshot and return; the write happens once no new snapshot has arrived for
+// the debounce interval, so typing never waits on the disk.
+class Autosaver {
+public:
+    explicit Autosaver(std::filesystem::path path, std::chrono::milliseconds delay = SaveConstants::debounce);
+    ~Autosaver();   // writes any pending snapshot before returning
+    void schedule(const SaveState& state);
+
+private:
+    void run();
+
+    std::filesystem::path path;
+    std::chrono::milliseconds delay;
+    std::mutex mutex;
+    std::condition_variable cv;
+    SaveState pending{};
+    bool hasPending = false;
+    bool stopping = false;
+    std::chrono::steady_clock::time_point lastChange;
+    std::thread worker;
+};
\ No newline at end of file
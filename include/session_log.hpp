@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "board.hpp"
+#include "difficulty.hpp"
+
+namespace SessionConstants {
+    constexpr uint32_t magic = 0x52445553;  // "SUDR"
+    constexpr uint16_t version = 1;
+    constexpr uint32_t ringCapacity = 4096; // events, power of two
+    constexpr auto flushInterval = std::chrono::milliseconds(50);
+}
+
+enum class SessionEventKind : uint8_t {
+    Puzzle,     // a new puzzle starts; value is its Difficulty, 81 Given events follow
+    Given,      // value is the given digit (0 if none) | solution digit << 8
+    Key,        // value is the curses key code, cell the cursor when it was pressed
+    Set,        // value is the digit now in cell (0 when cleared)
+    Pencil,     // value is the cell's pencil mark mask after the change
+    Dropped,    // value is how many events were lost because the buffer was full
+};
+
+// One 8-byte log record. Times are milliseconds since the recording started,
+// taken from the monotonic clock.
+struct SessionEvent {
+    uint32_t millis;
+    SessionEventKind kind;
+    uint8_t cell;
+    uint16_t value;
+};
+static_assert(sizeof(SessionEvent) == 8);
+static_assert(std::is_trivially_copyable_v<SessionEvent>);
+
+struct SessionHeader {
+    uint32_t magic = SessionConstants::magic;
+    uint16_t version = SessionConstants::version;
+    uint16_t reserved = 0;
+    int64_t startedAt = 0;  // wall clock, seconds since the epoch
+};
+static_assert(sizeof(SessionHeader) == 16);
+
+// Appends game events to a file without ever blocking the caller. Events go
+// into a fixed single-producer / single-consumer ring; a background thread
+// drains it to disk every flushInterval. If the ring is ever full the event
+// is dropped and counted rather than waited on.
+//
+// All the recording calls must come from one thread (the game loop).
+class SessionRecorder {
+public:
+    explicit SessionRecorder(const std::filesystem::path& path);
+    ~SessionRecorder();     // drains and flushes everything recorded so far
+    bool ok() const { return static_cast<bool>(out); }
+
+    void puzzle(const Board& givens, const Board& solution, Difficulty difficulty);
+    void key(int ch, int row, int col);
+    // logs Set / Pencil events for every cell that differs from the last call
+    void board(const Board& game, const std::array<std::array<uint16_t, 9>, 9>& pencil);
+
+private:
+    void push(SessionEventKind kind, int cell, uint16_t value);
+    void run();
+    void drain();
+
+    std::ofstream out;
+    std::chrono::steady_clock::time_point started;
+    std::array<SessionEvent, SessionConstants::ringCapacity> ring;
+    alignas(64) std::atomic<uint32_t> head{0};  // next slot the writer reads
+    alignas(64) std::atomic<uint32_t> tail{0};  // next slot the game fills
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<bool> stopping{false};
+    uint32_t droppedWritten = 0;
+
+    // game-thread copy of what has been logged, for diffing
+    Board lastGame;
+    std::array<uint16_t, 81> lastPencil{};
+    std::thread worker;
+};
+
+struct SessionLog {
+    SessionHeader header;
+    std::vector<SessionEvent> events;
+};
+
+std::optional<SessionLog> read_session(const std::filesystem::path& path);
+
+struct CellTiming {
+    bool solved = false;
+    uint32_t solvedAt = 0;      // when the correct digit went in for good
+    uint32_t think = 0;         // time since the previous cell was solved
+    uint32_t hesitation = 0;    // time the cursor sat on the cell before it was solved
+    int entries = 0;            // digits entered or cleared here, 1 if no second thoughts
+};
+
+// per-puzzle summary of a log; one log may hold several puzzles
+struct SessionAnalysis {
+    Board givens;
+    Board solution;
+    Difficulty difficulty = Difficulty::Easy;
+    uint32_t startedAt = 0;
+    uint32_t endedAt = 0;
+    int keys = 0;
+    int corrections = 0;    // entries beyond the first on any cell
+    bool solved = false;
+    uint32_t dropped = 0;
+    std::array<CellTiming, 81> cells{};
+};
+
+std::vector<SessionAnalysis> analyze_session(const SessionLog& log);
@@ -0,0 +1,12 @@
+#pragma once
+#include "board.hpp"
+#include "generator.hpp"
+
+// Lazily yields every solution of grid. The search is iterative over a
+// fixed 81-frame stack (most constrained cell first, digits ascending), so
+// the caller can stop after any solution and resume later with no recursion
+// and no allocation per solution. Yields nothing if the givens conflict.
+Generator<Board> enumerate_solutions(Board grid);
+
+// Exact number of solutions, stopping once `limit` is reached (0 = no limit).
+long long count_solutions(const Board& grid, long long limit = 0);
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Counters filled by Sudoku's solve / count / rating calls when a caller
+// points Sudoku::stats at one. Counters accumulate across calls until reset.
+struct SolverStats {
+    long long nodes = 0;             // search nodes (or technique passes when rating)
+    long long backtracks = 0;        // tentative assignments that had to be undone
+    int maxDepth = 0;
+    long long candidateChecks = 0;   // isSafe tests, or technique attempts when rating
+    long long propagationSteps = 0;  // placements and candidate eliminations when rating
+    std::chrono::nanoseconds wallTime{0};
+
+    void reset() { *this = SolverStats(); }
+};
+
+enum class TraceEvent : uint8_t {
+    Enter,      // visited a node, cell = cell being filled
+    Assign,     // tried digit in cell
+    Backtrack,  // undid digit in cell
+    Solution
+};
+
+// 8 bytes per event so a trace of millions of nodes stays small
+struct TraceRecord {
+    uint32_t node;
+    TraceEvent event;
+    uint8_t depth;
+    uint8_t cell;
+    uint8_t digit;
+};
+static_assert(sizeof(TraceRecord) == 8);
+
+// Fixed-capacity ring buffer of search events. Once full, the oldest events
+// are overwritten, so recording never allocates after construction.
+class SolverTrace {
+public:
+    // capacity is rounded up to a power of two
+    explicit SolverTrace(size_t capacity = 1 << 16);
+
+    void record(uint32_t node, TraceEvent event, int depth, int cell = 0, int digit = 0) {
+        buffer[head & mask] = TraceRecord{node, event, static_cast<uint8_t>(depth),
+                                          static_cast<uint8_t>(cell), static_cast<uint8_t>(digit)};
+        head++;
+    }
+    void clear() { head = 0; }
+    size_t size() const { return head < buffer.size() ? head : buffer.size(); }
+    size_t dropped() const { return head - size(); }
+    // events oldest first
+    std::vector<TraceRecord> events() const;
+
+    // raw records, for offline tools
+    void write(std::ostream& out) const;
+    // folded stacks ("r0c2=5;r1c4=7 <nodes>" per line) for flame graph tools,
+    // with paths cut off after maxDepth assignments
+    void write_folded(std::ostream& out, int maxDepth = 16) const;
+
+private:
+    std::vector<TraceRecord> buffer;
+    size_t mask;
+    size_t head = 0;
+};
\ No newline at end of file
@@ -8,7 +8,9 @@ class Stopwatch {
 public:
     Stopwatch() : start_time(std::chrono::steady_clock::now()) {}
     std::string elapsed_time() const;
-    void restart();
+    long elapsed_seconds() const;
+    // restart the clock as if `alreadyElapsed` had passed (used when resuming a saved game)
+    void restart(std::chrono::seconds alreadyElapsed = std::chrono::seconds(0));
 
 private:
     std::chrono::steady_clock::time_point start_time;
@@ -30,30 +30,96 @@ SOFTWARE.
 #include <sstream>
 #include <string>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include "solver_stats.hpp"
+#include "board.hpp"
+#include "solution_enumerator.hpp"
 
 #define UNASSIGNED 0
+// dead ends createSeed tolerates before restarting its search from scratch
+#define SEED_RESTART_LIMIT 50
+
+// Flag a caller can set from any thread (or from a progress callback) to
+// abandon a running generation.
+class CancelToken
+{
+public:
+  void cancel() { flag.store(true, std::memory_order_relaxed); }
+  void reset() { flag.store(false, std::memory_order_relaxed); }
+  bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<bool> flag{false};
+};
+
+struct GenProgress
+{
+  int cluesRemoved = 0;
+  int positionsTried = 0;
+  long long nodes = 0;      // search nodes visited by solveGrid / countSoln
+};
+
+// Limits for createSeed / genPuzzle. Cancellation and the deadline are
+// polled every few thousand search nodes, the node cap on every node.
+struct GenBudget
+{
+  const CancelToken* cancel = nullptr;
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+  long long maxNodes = 0;   // 0 means unlimited
+  std::function<void(const GenProgress&)> onProgress;
+};
+
+enum class GenStatus
+{
+  Complete,
+  Cancelled,
+  OutOfBudget
+};
+
+struct MinimalOptions;
 
 class Sudoku {
 public:
-  int grid[9][9];
-  int solnGrid[9][9];
-  int guessNum[9];
-  int gridPos[81];
+  Board grid;
+  Board solnGrid;
+  uint8_t guessNum[9];
+  uint8_t gridPos[81];
   int difficultyLevel;
   bool grid_status;
+  const GenBudget* budget = nullptr;
+  GenProgress progress;
+  GenStatus genStatus = GenStatus::Complete;
+  // optional instrumentation, filled by solveGrid / countSoln / calculateDifficulty when set
+  SolverStats* stats = nullptr;
+  SolverTrace* trace = nullptr;
+  int searchDepth = 0;
+  std::minstd_rand rng;
 
 public:
   Sudoku ();
+  explicit Sudoku (uint64_t seed);
   Sudoku (std::string, bool row_major=true);
-  void fillEmptyDiagonalBox(int);
   void createSeed();
+  GenStatus createSeed(const GenBudget&);
+  bool fillRandomGrid(std::array<uint16_t, 27>& used, int& deadEnds);
+  void shuffleGrid();
   void printGrid();
   bool solveGrid();
   std::string getGrid();
   void countSoln(int &number);
+  Generator<Board> solutions() const;
   void genPuzzle();
+  GenStatus genPuzzle(const GenBudget&);
+  GenStatus genMinimalPuzzle(const MinimalOptions&, const GenBudget&);
+  bool visitNode();
+  bool checkBudget();
+  void recordNode(int row, int col);
+  void recordAssign(int row, int col, int num);
+  void recordBacktrack(int row, int col, int num);
   bool verifyGridStatus();
   void printSVG(std::string);
   void calculateDifficulty();
-  int  branchDifficultyScore();
 };
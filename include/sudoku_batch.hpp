@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include "board.hpp"
+
+class ResultCache;
+
+// Batch entry points of libsudoku. Each call works through its spans in
+// order and keeps no state between calls, so any number of threads can call
+// them at once on separate spans. Output spans must be at least as long as
+// the input; the functions return false (and do nothing) otherwise.
+//
+// solve / count / grade take an optional ResultCache. Answers are looked up
+// there first, and a miss stores the puzzle's full result (solution, count
+// and score), so a miss costs a little more than the uncached call.
+
+// solutions[i] = first solution of puzzles[i], or an empty Board if it has none.
+// solved, if not empty, receives 1 / 0 per puzzle.
+bool solve_batch(std::span<const Board> puzzles, std::span<Board> solutions, std::span<uint8_t> solved = {},
+                 ResultCache* cache = nullptr);
+
+// Most solutions count_batch will count for one puzzle. An empty grid has
+// about 6.7e21, so "all of them" needs a ceiling that keeps the call short
+// and the result in an int.
+constexpr int maxSolutionCount = 1000000;
+
+// counts[i] = number of solutions of puzzles[i], stopping at limit;
+// limit <= 0 or above maxSolutionCount means maxSolutionCount. The cache
+// only knows counts up to 2, so it is used only for limit 1 or 2.
+bool count_batch(std::span<const Board> puzzles, int limit, std::span<int> counts, ResultCache* cache = nullptr);
+
+// scores[i] = logic difficulty score of puzzles[i] (see Sudoku::calculateDifficulty)
+bool grade_batch(std::span<const Board> puzzles, std::span<int> scores, ResultCache* cache = nullptr);
+
+// fills puzzles (and solutions / scores if not empty) with puzzles generated
+// from seed, seed + 1, ...; the same seed always gives the same puzzles
+bool generate_batch(uint64_t seed, std::span<Board> puzzles, std::span<Board> solutions = {}, std::span<int> scores = {});
\ No newline at end of file
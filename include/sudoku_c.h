@@ -0,0 +1,38 @@
+/* Plain C interface to libsudoku.
+ *
+ * A grid is 81 bytes in row-major order, each 0 (empty) or 1..9. Batches
+ * are n grids packed back to back. Bytes outside 0..9 make a grid invalid:
+ * it is reported unsolved, with 0 solutions and a score of -1. All
+ * functions are reentrant. */
+#ifndef SUDOKU_C_H
+#define SUDOKU_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SUDOKU_GRID_SIZE 81
+/* Most solutions sudoku_count counts for one puzzle. */
+#define SUDOKU_COUNT_MAX 1000000
+
+/* Returns how many puzzles were solved; unsolvable ones get an all-zero solution. */
+size_t sudoku_solve(const uint8_t* puzzles, uint8_t* solutions, size_t n);
+
+/* counts[i] = solutions of puzzle i, stopping at limit. limit <= 0 or above
+ * SUDOKU_COUNT_MAX counts up to SUDOKU_COUNT_MAX. */
+void sudoku_count(const uint8_t* puzzles, int limit, int* counts, size_t n);
+
+/* scores[i] = logic difficulty score (by default <= 400 easy, <= 800 medium, <= 1100 hard, above: master). */
+void sudoku_grade(const uint8_t* puzzles, int* scores, size_t n);
+
+/* Generates n puzzles from seed, seed + 1, ...; solutions and scores may be NULL. */
+void sudoku_generate(uint64_t seed, uint8_t* puzzles, uint8_t* solutions, int* scores, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#include "bit_solver.hpp"
+#include <algorithm>
+#include <bit>
+
+BitSolver::BitSolver(const Board& grid) {
+    for (int idx = 0; idx < 81; idx++) {
+        int value = grid.cells[idx];
+        if (value < 1 || value > 9) {
+            empty[emptyCount++] = idx;
+            continue;
+        }
+        uint16_t bit = 1 << (value - 1);
+        int r = idx / 9, c = idx % 9, b = boxOf(idx);
+        if ((rows[r] | cols[c] | boxes[b]) & bit) {
+            consistent = false;
+        }
+        board.cells[idx] = value;
+        rows[r] |= bit;
+        cols[c] |= bit;
+        boxes[b] |= bit;
+    }
+}
+
+bool BitSolver::solve(Board& out) {
+    auto start = std::chrono::steady_clock::now();
+    bool found = consistent && search(0, 1, 0, &out) > 0;
+    if (stats) {
+        stats->wallTime += std::chrono::steady_clock::now() - start;
+    }
+    return found;
+}
+
+int BitSolver::count(int limit) {
+    auto start = std::chrono::steady_clock::now();
+    int found = consistent ? search(0, limit, 0, nullptr) : 0;
+    if (stats) {
+        stats->wallTime += std::chrono::steady_clock::now() - start;
+    }
+    return found;
+}
+
+// empty[depth..emptyCount) are the unfilled cells; returns the running total of solutions
+int BitSolver::search(int depth, int limit, int found, Board* out) {
+    if (stats) {
+        stats->nodes++;
+        stats->maxDepth = std::max(stats->maxDepth, depth);
+    }
+    if (depth == emptyCount) {
+        if (out != nullptr) {
+            *out = board;
+        }
+        return found + 1;
+    }
+
+    // pick the most constrained remaining cell
+    int best = depth, bestCount = 10;
+    uint16_t bestCandidates = 0;
+    for (int i = depth; i < emptyCount; i++) {
+        int idx = empty[i];
+        uint16_t candidates = allDigits & ~(rows[idx / 9] | cols[idx % 9] | boxes[boxOf(idx)] | forbidden[idx]);
+        int count = std::popcount(candidates);
+        if (stats) {
+            stats->candidateChecks++;
+        }
+        if (count < bestCount) {
+            best = i;
+            bestCount = count;
+            bestCandidates = candidates;
+            if (count <= 1) {
+                break;
+            }
+        }
+    }
+    if (bestCount == 0) {
+        return found;
+    }
+
+    std::swap(empty[depth], empty[best]);
+    int idx = empty[depth];
+    int r = idx / 9, c = idx % 9, b = boxOf(idx);
+    while (bestCandidates && found < limit) {
+        uint16_t bit = bestCandidates & -bestCandidates;
+        bestCandidates &= bestCandidates - 1;
+        board.cells[idx] = std::countr_zero(bit) + 1;
+        rows[r] |= bit;
+        cols[c] |= bit;
+        boxes[b] |= bit;
+        found = search(depth + 1, limit, found, out);
+        rows[r] &= ~bit;
+        cols[c] &= ~bit;
+        boxes[b] &= ~bit;
+        board.cells[idx] = 0;
+        if (stats && found < limit) {
+            stats->backtracks++;
+        }
+    }
+    std::swap(empty[depth], empty[best]);
+    return found;
+}
\ No newline at end of file
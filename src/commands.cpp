@@ -0,0 +1,388 @@
+#include "commands.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game.hpp"
+#include "minimal_generator.hpp"
+#include "puzzle_book.hpp"
+#include "session_log.hpp"
+#include "sudoku.hpp"
+#include "sudoku_batch.hpp"
+
+namespace {
+    void usage() {
+        std::cerr << "usage: sudokurse                 play in the terminal\n"
+                  << "       sudokurse export COUNT FILE [--per-page N] [--columns N] [--solutions] [--text]\n"
+                  << "                        [--minimal [--clues N] [--symmetry none|rotational|diagonal|quarter]]\n"
+                  << "       sudokurse record FILE       play, logging every key and board change to FILE\n"
+                  << "       sudokurse replay FILE [--speed X]\n"
+                  << "       sudokurse analyze FILE\n"
+                  << "       sudokurse calibrate [COUNT] [--threads N] [--seed N] [--output FILE]\n";
+    }
+
+    bool parse_symmetry(const std::string& name, Symmetry& symmetry) {
+        const char* names[] = {"none", "rotational", "diagonal", "quarter"};
+        for (int i = 0; i < 4; i++) {
+            if (name == names[i]) {
+                symmetry = static_cast<Symmetry>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string seconds(uint32_t millis) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1) << millis / 1000.0;
+        return out.str();
+    }
+
+    std::string cell_name(int cell) {
+        std::string name = "r";
+        name += std::to_string(cell / 9 + 1);
+        name += 'c';
+        name += std::to_string(cell % 9 + 1);
+        return name;
+    }
+
+    void print_board(const Board& board) {
+        for (int row = 0; row < 9; row++) {
+            std::cout << "  ";
+            for (int col = 0; col < 9; col++) {
+                std::cout << (board[row][col] ? static_cast<char>('0' + board[row][col]) : '.')
+                          << (col % 3 == 2 && col < 8 ? " | " : " ");
+            }
+            std::cout << "\n" << (row % 3 == 2 && row < 8 ? "  ------+-------+------\n" : "");
+        }
+    }
+}
+
+int run_command(int argc, char* argv[]) {
+    std::string command = argv[1];
+    if (command == "export") {
+        return export_book(argc - 2, argv + 2);
+    }
+    if (command == "record") {
+        return record_game(argc - 2, argv + 2);
+    }
+    if (command == "replay") {
+        return replay_session(argc - 2, argv + 2);
+    }
+    if (command == "analyze") {
+        return analyze_log(argc - 2, argv + 2);
+    }
+    if (command == "calibrate") {
+        return calibrate(argc - 2, argv + 2);
+    }
+    usage();
+    return 2;
+}
+
+// export COUNT FILE [--per-page N] [--columns N] [--solutions] [--text]
+//        [--minimal [--clues N] [--symmetry none|rotational|diagonal|quarter]]
+// --minimal makes every puzzle minimal (see minimal_generator.hpp), the
+// low-clue kind the Master tier wants; --clues and --symmetry imply it
+int export_book(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    int count = std::atoi(argv[0]);
+    std::string path = argv[1];
+    BookOptions options;
+    bool minimal = false;
+    MinimalOptions minimalOptions;
+    for (int i = 2; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--per-page") && i + 1 < argc) {
+            options.perPage = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--columns") && i + 1 < argc) {
+            options.columns = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--solutions")) {
+            options.solutions = true;
+        } else if (!std::strcmp(argv[i], "--text")) {
+            options.format = BookFormat::Text;
+        } else if (!std::strcmp(argv[i], "--minimal")) {
+            minimal = true;
+        } else if (!std::strcmp(argv[i], "--clues") && i + 1 < argc) {
+            minimal = true;
+            minimalOptions.targetClues = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--symmetry") && i + 1 < argc && parse_symmetry(argv[i + 1], minimalOptions.symmetry)) {
+            minimal = true;
+            i++;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    options.expectedPuzzles = count;
+
+    // one large buffer for the whole book; PuzzleBook writes a page at a time
+    std::vector<char> streamBuffer(1 << 20);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(streamBuffer.data(), streamBuffer.size());
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "cannot write " << path << std::endl;
+        return 1;
+    }
+
+    PuzzleBook book(out, options);
+    int notMinimal = 0;
+    for (int i = 0; i < count; i++) {
+        Sudoku puzzle;
+        puzzle.createSeed();
+        if (minimal) {
+            // without a symmetry every finished attempt is minimal; with one
+            // the best may only be minimal within the pattern
+            notMinimal += puzzle.genMinimalPuzzle(minimalOptions, GenBudget()) != GenStatus::Complete;
+        } else {
+            puzzle.genPuzzle();
+        }
+        puzzle.calculateDifficulty();
+        book.add(puzzle.grid, puzzle.difficultyLevel, puzzle.solnGrid);
+        std::cerr << "\r" << i + 1 << "/" << count << std::flush;
+    }
+    book.finish();
+    std::cerr << "\nwrote " << count << " puzzles on " << book.pages() << " pages to " << path << std::endl;
+    if (notMinimal > 0) {
+        std::cerr << notMinimal << " of them missed the clue target or are only minimal within the symmetry" << std::endl;
+    }
+    return out ? 0 : 1;
+}
+// record FILE
+int record_game(int argc, char* argv[]) {
+    if (argc != 1) {
+        usage();
+        return 2;
+    }
+    auto game = std::make_unique<Game>();
+    if (!game->record_to(argv[0])) {
+        std::cerr << "cannot write " << argv[0] << std::endl;
+        return 1;
+    }
+    game->start();
+    return 0;
+}
+
+// replay FILE [--speed X]: prints the log back as it happened. With a speed
+// the original pauses are kept (scaled), otherwise it runs flat out.
+int replay_session(int argc, char* argv[]) {
+    double speed = 0;
+    if (argc == 3 && !std::strcmp(argv[1], "--speed")) {
+        speed = std::atof(argv[2]);
+    } else if (argc != 1) {
+        usage();
+        return 2;
+    }
+    auto log = read_session(argv[0]);
+    if (!log) {
+        std::cerr << "not a session log: " << argv[0] << std::endl;
+        return 1;
+    }
+
+    Board board, solution;
+    uint32_t previous = 0;
+    for (const auto& event : log->events) {
+        if (speed > 0 && event.millis > previous) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>((event.millis - previous) / speed));
+        }
+        previous = event.millis;
+
+        auto when = seconds(event.millis) + "s  ";
+        when.insert(0, std::max<int>(0, 11 - static_cast<int>(when.size())), ' ');
+        switch (event.kind) {
+            case SessionEventKind::Puzzle:
+                std::cout << when << "new puzzle (" << difficulty_str(static_cast<Difficulty>(event.value)) << ")\n";
+                break;
+            case SessionEventKind::Given:
+                board.cells[event.cell] = event.value & 0xFF;
+                solution.cells[event.cell] = event.value >> 8;
+                break;
+            case SessionEventKind::Set:
+                board.cells[event.cell] = event.value;
+                std::cout << when << cell_name(event.cell) << " = "
+                          << (event.value ? std::to_string(event.value) : "cleared")
+                          << (event.value && event.value != solution.cells[event.cell] ? " (wrong)" : "") << "\n";
+                break;
+            case SessionEventKind::Pencil: {
+                std::cout << when << cell_name(event.cell) << " pencil";
+                for (int digit = 1; digit <= 9; digit++) {
+                    if (event.value & (1 << (digit - 1))) {
+                        std::cout << ' ' << digit;
+                    }
+                }
+                std::cout << "\n";
+                break;
+            }
+            case SessionEventKind::Dropped:
+                std::cout << when << event.value << " events lost\n";
+                break;
+            case SessionEventKind::Key:
+                break;
+        }
+        if (speed > 0) {
+            std::cout << std::flush;
+        }
+    }
+    print_board(board);
+    std::cout << (board == solution && solution != Board{} ? "solved" : "not solved") << std::endl;
+    return 0;
+}
+
+// analyze FILE: per-cell solve times and hesitation for each puzzle in the log
+int analyze_log(int argc, char* argv[]) {
+    if (argc != 1) {
+        usage();
+        return 2;
+    }
+    auto log = read_session(argv[0]);
+    if (!log) {
+        std::cerr << "not a session log: " << argv[0] << std::endl;
+        return 1;
+    }
+
+    auto puzzles = analyze_session(*log);
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        const auto& puzzle = puzzles[i];
+        std::cout << "puzzle " << i + 1 << " (" << difficulty_str(puzzle.difficulty) << "): "
+                  << (puzzle.solved ? "solved" : "not solved") << " after " << seconds(puzzle.endedAt - puzzle.startedAt)
+                  << "s, " << puzzle.keys << " keys, " << puzzle.corrections << " corrections";
+        if (puzzle.dropped) {
+            std::cout << ", " << puzzle.dropped << " events lost";
+        }
+        std::cout << "\nseconds spent on each cell (. given, - unsolved):\n";
+        for (int row = 0; row < 9; row++) {
+            for (int col = 0; col < 9; col++) {
+                int cell = row * 9 + col;
+                std::string text = puzzle.givens.cells[cell] ? "." : puzzle.cells[cell].solved ? seconds(puzzle.cells[cell].think) : "-";
+                std::cout << std::setw(7) << text;
+            }
+            std::cout << "\n";
+        }
+
+        std::vector<int> order;
+        for (int cell = 0; cell < 81; cell++) {
+            if (puzzle.cells[cell].solved) {
+                order.push_back(cell);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return puzzle.cells[a].think > puzzle.cells[b].think; });
+        order.resize(std::min<size_t>(order.size(), 5));
+        if (!order.empty()) {
+            std::cout << "slowest cells:\n";
+        }
+        for (int cell : order) {
+            const auto& timing = puzzle.cells[cell];
+            std::cout << "  " << cell_name(cell) << std::setw(8) << seconds(timing.think) << "s, cursor on it "
+                      << seconds(timing.hesitation) << "s, " << timing.entries << (timing.entries == 1 ? " entry" : " entries") << "\n";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+// calibrate [COUNT] [--threads N] [--seed N] [--output FILE]: grades COUNT
+// generated puzzles and puts the band cutoffs at the quartiles of their
+// scores, so each difficulty gets about a quarter of all generated puzzles
+int calibrate(int argc, char* argv[]) {
+    int count = 2000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::filesystem::path path = default_thresholds_path();
+    for (int i = 0; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--output") && i + 1 < argc) {
+            path = argv[++i];
+        } else if (i == 0 && std::atoi(argv[i]) > 0) {
+            count = std::atoi(argv[i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    // the "old share" column compares against the cutoffs being replaced
+    DifficultyThresholds previous = read_thresholds(path).value_or(load_difficulty_thresholds());
+
+    // workers take small chunks off a shared counter so a slow chunk never
+    // leaves the other cores idle; chunk i always uses the same seeds
+    constexpr int chunk = 8;
+    std::vector<Board> puzzles(count);
+    std::vector<int> scores(count);
+    std::atomic<int> nextChunk{0}, done{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (int begin = nextChunk++ * chunk; begin < count; begin = nextChunk++ * chunk) {
+                int n = std::min(chunk, count - begin);
+                generate_batch(seed + begin, std::span(puzzles).subspan(begin, n), {}, std::span(scores).subspan(begin, n));
+                done += n;
+            }
+        });
+    }
+    auto started = std::chrono::steady_clock::now();
+    while (done < count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::cerr << "\r" << done << "/" << count << std::flush;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    std::cerr << "\r" << count << " puzzles graded on " << threads << " threads in "
+              << std::fixed << std::setprecision(1) << elapsed.count() << "s" << std::endl;
+
+    std::sort(scores.begin(), scores.end());
+    DifficultyThresholds calibrated;
+    for (int i = 0; i < difficultyCount - 1; i++) {
+        calibrated.upper[i] = scores[static_cast<size_t>(count) * (i + 1) / difficultyCount - (count >= difficultyCount)];
+        // many puzzles can share a score; cutoffs still have to go up
+        if (i > 0 && calibrated.upper[i] <= calibrated.upper[i - 1]) {
+            calibrated.upper[i] = calibrated.upper[i - 1] + 1;
+        }
+    }
+
+    // histogram in fixed-width buckets, with each band's share under the old and new cutoffs
+    constexpr int bucket = 100;
+    std::vector<int> histogram(scores.back() / bucket + 1);
+    for (int score : scores) {
+        histogram[score / bucket]++;
+    }
+    int peak = *std::max_element(histogram.begin(), histogram.end());
+    for (size_t b = 0; b < histogram.size(); b++) {
+        std::cout << std::setw(5) << b * bucket << "-" << std::setw(5) << std::left << (b + 1) * bucket - 1 << std::right
+                  << std::setw(7) << histogram[b] << " " << std::string(histogram[b] * 50 / peak, '#') << "\n";
+    }
+    std::cout << "\nband       old share  new cutoff  new share\n" << std::fixed << std::setprecision(1);
+    for (int d = 0; d < difficultyCount; d++) {
+        int before = 0, after = 0;
+        for (int score : scores) {
+            before += classify_difficulty(score, previous) == static_cast<Difficulty>(d);
+            after += classify_difficulty(score, calibrated) == static_cast<Difficulty>(d);
+        }
+        std::string cutoff = d < difficultyCount - 1 ? std::to_string(calibrated.upper[d]) : "-";
+        std::cout << std::left << std::setw(10) << difficulty_str(static_cast<Difficulty>(d)) << std::right
+                  << std::setw(9) << 100.0 * before / count << "%" << std::setw(12) << cutoff
+                  << std::setw(10) << 100.0 * after / count << "%\n";
+    }
+
+    auto comment = "written by sudokurse calibrate from " + std::to_string(count) + " puzzles";
+    if (!write_thresholds(path, calibrated, comment)) {
+        std::cerr << "cannot write " << path << std::endl;
+        return 1;
+    }
+    std::cout << "\nwrote " << path.string() << std::endl;
+    return 0;
+}
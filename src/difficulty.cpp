@@ -0,0 +1,105 @@
+#include "difficulty.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+std::string difficulty_str(Difficulty d) {
+    switch (d) {
+        case Difficulty::Easy:
+            return "easy";
+        case Difficulty::Medium:
+            return "medium";
+        case Difficulty::Hard:
+            return "hard";
+        case Difficulty::Master:
+            return "master";
+    }
+    return "UNKNOWN";
+}
+
+bool parse_difficulty(const std::string& name, Difficulty& d) {
+    for (int i = 0; i < difficultyCount; i++) {
+        if (difficulty_str(static_cast<Difficulty>(i)) == name) {
+            d = static_cast<Difficulty>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Difficulty classify_difficulty(int difficultyLevel, const DifficultyThresholds& thresholds) {
+    for (int i = 0; i < difficultyCount - 1; i++) {
+        if (difficultyLevel <= thresholds.upper[i]) {
+            return static_cast<Difficulty>(i);
+        }
+    }
+    return Difficulty::Master;
+}
+
+std::filesystem::path default_thresholds_path() {
+    if (const char* xdg = std::getenv("XDG_CONFIG_HOME"); xdg && *xdg) {
+        return std::filesystem::path(xdg) / "sudokurse" / "difficulty.conf";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path(home) / ".config" / "sudokurse" / "difficulty.conf";
+    }
+    return "difficulty.conf";
+}
+
+std::optional<DifficultyThresholds> read_thresholds(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+    DifficultyThresholds result;
+    std::array<bool, difficultyCount - 1> seen{};
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        auto eq = line.find('=');
+        if (eq == std::string::npos) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                return std::nullopt;
+            }
+            continue;
+        }
+        std::string key, rest;
+        std::istringstream(line.substr(0, eq)) >> key;
+        std::istringstream value(line.substr(eq + 1));
+        int level;
+        Difficulty d;
+        if (!(value >> level) || (value >> rest) || !parse_difficulty(key, d) || d == Difficulty::Master) {
+            return std::nullopt;
+        }
+        result.upper[static_cast<int>(d)] = level;
+        seen[static_cast<int>(d)] = true;
+    }
+    // every band needs a cutoff, and they have to go up
+    for (int i = 0; i < difficultyCount - 1; i++) {
+        if (!seen[i] || (i > 0 && result.upper[i] <= result.upper[i - 1])) {
+            return std::nullopt;
+        }
+    }
+    return result;
+}
+
+bool write_thresholds(const std::filesystem::path& path, const DifficultyThresholds& thresholds, const std::string& comment) {
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+    std::ofstream out(path, std::ios::trunc);
+    if (!comment.empty()) {
+        out << "# " << comment << "\n";
+    }
+    out << "# highest difficulty score in each band; anything above hard is master\n";
+    for (int i = 0; i < difficultyCount - 1; i++) {
+        out << difficulty_str(static_cast<Difficulty>(i)) << "=" << thresholds.upper[i] << "\n";
+    }
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+DifficultyThresholds load_difficulty_thresholds() {
+    return read_thresholds(default_thresholds_path()).value_or(DifficultyThresholds());
+}
\ No newline at end of file
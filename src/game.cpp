@@ -1,31 +1,18 @@
 #include <game.hpp>
 #include <ncurses.h>
+#include <algorithm>
 #include <cstdlib>
 #include "utils.hpp"
 #include <iostream>
 #include "sudoku.hpp"
+#include <bit>
 #include <chrono>
 #include <thread>
 #include "stopwatch.hpp"
 
 using namespace GameConstants;
 
-std::string difficulty_str(Difficulty d) {
-    switch (d) {
-        case Difficulty::Easy:
-            return "easy";
-        case Difficulty::Medium:
-            return "medium";
-        case Difficulty::Hard:
-            return "hard";
-        case Difficulty::Master:
-            return "master";
-    }
-    return "UNKNOWN";
-}
-
 Game::Game() {
-    srand(time(NULL));  // init random seed
 }
 
 Game::~Game() {
@@ -35,38 +22,135 @@ Game::~Game() {
 void Game::reset_game() {
     // initialize solution board and initial game state
     auto puzzle = Sudoku();
-    puzzle.createSeed();
-    puzzle.genPuzzle();
+    CancelToken cancel;
+    GenBudget budget;
+    budget.cancel = &cancel;
+    budget.onProgress = [&](const GenProgress& progress) {
+        draw_generation_progress(progress);
+        switch (getch()) {
+            case 'q':
+            case 'Q':
+                quitRequested = true;
+                cancel.cancel();
+                break;
+            case 'n':
+            case 'N':
+                cancel.cancel();
+                break;
+        }
+    };
+
+    // pressing N while generating starts over with a fresh time limit, Q
+    // abandons generation entirely; running out of time keeps the best
+    // puzzle found so far, so a new game never takes much more than
+    // generationTimeLimit + generationGrace
+    using Clock = std::chrono::steady_clock;
+    auto status = GenStatus::Cancelled;
+    auto deadline = Clock::now() + generationTimeLimit;
+    while (status != GenStatus::Complete && !quitRequested) {
+        if (cancel.cancelled()) {
+            deadline = Clock::now() + generationTimeLimit;
+        }
+        cancel.reset();
+        budget.deadline = deadline;
+        puzzle = Sudoku();
+        status = puzzle.createSeed(budget);
+        if (status == GenStatus::OutOfBudget) {
+            // filling a grid takes milliseconds, so only a nearly spent limit gets
+            // here; finish it regardless rather than starting another attempt
+            budget.deadline = Clock::time_point::max();
+            status = puzzle.createSeed(budget);
+        }
+        if (status == GenStatus::Complete) {
+            budget.deadline = std::max(deadline, Clock::now() + generationGrace);
+            status = puzzle.genPuzzle(budget);
+            if (status == GenStatus::OutOfBudget) {
+                status = GenStatus::Complete;
+            }
+        }
+    }
+    if (quitRequested) {
+        return;
+    }
+
     puzzle.calculateDifficulty();
-    if (puzzle.difficultyLevel <= 400) {
-        difficulty = Difficulty::Easy;
-    } else if (puzzle.difficultyLevel <= 800) {
-        difficulty = Difficulty::Medium;
-    } else if (puzzle.difficultyLevel <= 1100) {
-        difficulty = Difficulty::Hard;
-    } else {
-        difficulty = Difficulty::Master;
+    difficulty = classify_difficulty(puzzle.difficultyLevel, thresholds);
+
+    game = puzzle.grid;
+    pencil = {};
+    solution = puzzle.solnGrid;
+    initialState = puzzle.grid;
+    if (recorder) {
+        recorder->puzzle(initialState, solution, difficulty);
     }
 
+    // reset stopwatch as last step so it doesn't clock up seconds during CPU blocks
+    stopwatch->restart();
+    boardChanged = true;
+}
+
+SaveState Game::snapshot() const {
+    SaveState state;
+    state.difficulty = static_cast<uint8_t>(difficulty);
+    state.elapsedSeconds = stopwatch->elapsed_seconds();
+    state.cursorY = cursorY;
+    state.cursorX = cursorX;
+    state.game = game;
     for (int r = 0; r < 9; r++) {
         for (int c = 0; c < 9; c++) {
-            game[r][c] = puzzle.grid[r][c];
-            penciled1[r][c] = unset;
-            penciled2[r][c] = unset;
-            solution[r][c] = puzzle.solnGrid[r][c];
-            initialState[r][c] = puzzle.grid[r][c];
+            state.pencil[r * 9 + c] = pencil[r][c];
         }
     }
+    state.initialState = initialState;
+    state.solution = solution;
+    return state;
+}
 
-    // reset stopwatch as last step so it doesn't clock up seconds during CPU blocks
-    stopwatch->restart();
+void Game::restore(const SaveState& state) {
+    difficulty = static_cast<Difficulty>(state.difficulty);
+    move_cursor(state.cursorY, state.cursorX);
+    game = state.game;
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            pencil[r][c] = state.pencil[r * 9 + c];
+        }
+    }
+    initialState = state.initialState;
+    solution = state.solution;
+    stopwatch->restart(std::chrono::seconds(state.elapsedSeconds));
+    if (recorder) {
+        recorder->puzzle(initialState, solution, difficulty);
+        recorder->board(game, pencil);
+    }
+}
+
+bool Game::record_to(const std::filesystem::path& path) {
+    recorder = std::make_unique<SessionRecorder>(path);
+    if (!recorder->ok()) {
+        recorder.reset();
+        return false;
+    }
+    return true;
 }
 
 void Game::start() {
+    thresholds = load_difficulty_thresholds();
     init_view();
     stopwatch = std::make_unique<Stopwatch>();
-    reset_game();
+    autosaver = std::make_unique<Autosaver>(default_save_path());
+    // a finished board (solved or auto-solved) is not worth resuming
+    auto saved = read_save(default_save_path());
+    if (saved && saved->game != saved->solution) {
+        restore(*saved);
+    } else {
+        reset_game();
+    }
     update_loop();
+    // save once more on quit so the elapsed time is up to date,
+    // unless we quit before the first puzzle was generated
+    if (solution[0][0] != unset) {
+        autosaver->schedule(snapshot());
+    }
 }
 
 void Game::init_view() const {
@@ -104,6 +188,7 @@ void Game::refresh_view() {
     attroff(COLOR_PAIR(cursorColorPair));
 
     draw_help();
+    draw_pencil_marks();
 
     // draw error / success
     if (errorText != "" || successText != "") {
@@ -132,25 +217,38 @@ void Game::draw_help() const {
     mvaddstr(y++, x, "[ARROW KEYS]   Move cursor");
     mvaddstr(y++, x, "[1..9]         Set number at cursor position");
     mvaddstr(y++, x, "[C]            Clear number at cursor position");
-    mvaddstr(y++, x, "[SHIFT + 1..9] Pencil-in number at cursor position");
-    mvaddstr(y++, x, "[SHIFT + C]    Clear penciled-in numbers at cursor position");
+    mvaddstr(y++, x, "[SHIFT + 1..9] Toggle pencil mark at cursor position");
+    mvaddstr(y++, x, "[SHIFT + C]    Clear pencil marks at cursor position");
+    mvaddstr(y++, x, "[F]            Pencil in every candidate");
     y++;
     mvaddstr(y++, x, "[ENTER] Present solution");
     y++;
     mvaddstr(y++, x, "[R]         Reset all numbers");
-    mvaddstr(y++, x, "[SHIFT + R] Reset all penciled-in numbers");
+    mvaddstr(y++, x, "[SHIFT + R] Reset all pencil marks");
     mvaddstr(y++, x, "[N]         New game");
     mvaddstr(y++, x, "[Q]         Quit game");
     y++;
     mvaddstr(y++, x, "[S] Auto solve");
 }
 
+void Game::draw_generation_progress(const GenProgress& progress) const {
+    auto text = "Generating puzzle... " + std::to_string(progress.cluesRemoved) + " clues removed, "
+        + std::to_string(progress.nodes) + " nodes searched";
+    move(23, cellWidth * offsetX);
+    clrtoeol();
+    mvaddstr(23, cellWidth * offsetX, text.c_str());
+    refresh();
+}
+
 void Game::update_loop() {
-    while (true) {
+    while (!quitRequested) {
         erase();
         refresh_view();
         
         int ch = getch();
+        if (recorder && ch != ERR) {
+            recorder->key(ch, cursorY, cursorX);
+        }
         switch (ch) {
             case 'q':
             case 'Q':
@@ -181,13 +279,17 @@ void Game::update_loop() {
                 reset_game();
                 break;
             case 'R':
-                penciled1 = std::array<std::array<int, 9>, 9>{};
-                penciled2 = std::array<std::array<int, 9>, 9>{};
+                pencil = {};
+                boardChanged = true;
                 break;
             case 'r':
                 game = initialState;
-                penciled1 = std::array<std::array<int, 9>, 9>{};
-                penciled2 = std::array<std::array<int, 9>, 9>{};
+                pencil = {};
+                boardChanged = true;
+                break;
+            case 'f':
+            case 'F':
+                fill_pencil_marks();
                 break;
             case KEY_ENTER:
             case 10:    // \n
@@ -226,6 +328,13 @@ void Game::update_loop() {
                 set_at_cursor(9, true);
                 break;
         }
+        if (boardChanged) {
+            if (recorder) {
+                recorder->board(game, pencil);
+            }
+            autosaver->schedule(snapshot());
+            boardChanged = false;
+        }
         refresh();
         std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 50 FPS
     }
@@ -253,16 +362,43 @@ void Game::draw_cell(int row, int col) const {
             attroff(COLOR_PAIR(yellowColorPair));
         }
     }
-    // check if there's a penciled value here as well
+    // otherwise show the pencil marks: up to three fit, beyond that the first two and a '+'
+    uint16_t marks = pencil[row][col];
+    if (value != unset || marks == 0) {
+        return;
+    }
     attron(COLOR_PAIR(redColorPair));
-    value = penciled1[row][col];
-    if (value != unset) {
-        mvaddch(y * cellHeight + 1, x * cellWidth + 1, int_to_char(value));
+    int shown = 0;
+    int count = std::popcount(marks);
+    for (int digit = 1; digit <= 9 && shown < 3; digit++) {
+        if (!(marks & (1 << (digit - 1)))) {
+            continue;
+        }
+        if (count > 3 && shown == 2) {
+            mvaddch(y * cellHeight + 1, x * cellWidth + 3, '+');
+            break;
+        }
+        mvaddch(y * cellHeight + 1, x * cellWidth + 1 + shown, int_to_char(digit));
+        shown++;
     }
-    value = penciled2[row][col];
-    if (value != unset) {
-        mvaddch(y * cellHeight + 1, x * cellWidth + 3, int_to_char(value));
+    attroff(COLOR_PAIR(redColorPair));
+}
+
+// full list of the cursor cell's pencil marks, under the grid
+void Game::draw_pencil_marks() const {
+    uint16_t marks = pencil[cursorY][cursorX];
+    if (marks == 0 || game[cursorY][cursorX] != unset) {
+        return;
+    }
+    std::string text = "Pencil:";
+    for (int digit = 1; digit <= 9; digit++) {
+        if (marks & (1 << (digit - 1))) {
+            text += ' ';
+            text += int_to_char(digit);
+        }
     }
+    attron(COLOR_PAIR(redColorPair));
+    mvaddstr((offsetY + 9) * cellHeight + 1, cellWidth * offsetX, text.c_str());
     attroff(COLOR_PAIR(redColorPair));
 }
 
@@ -293,11 +429,11 @@ void Game::clear(int row, int col, bool isPenciled) {
         return;
     }
     if (isPenciled) {
-        penciled1[row][col] = unset;
-        penciled2[row][col] = unset;
+        pencil[row][col] = 0;
     } else {
         game[row][col] = unset;
     }
+    boardChanged = true;
 }
 void Game::clear_at_cursor(bool isPenciled) {
     clear(cursorY, cursorX, isPenciled);
@@ -315,15 +451,42 @@ void Game::set(int row, int col, int value, bool isPenciled) {
         value = unset;
     }
     if (isPenciled) {
-        if (!isPencil2) {
-            penciled1[row][col] = value;
-        } else {
-            penciled2[row][col] = value;
+        if (value != unset) {
+            pencil[row][col] ^= 1 << (value - 1);
         }
-        isPencil2 = !isPencil2;
     } else {
         game[row][col] = value;
+        if (value != unset) {
+            // the digit can no longer be a candidate anywhere it could see
+            pencil[row][col] = 0;
+            uint16_t bit = 1 << (value - 1);
+            for (int peer : peerCells[row * 9 + col]) {
+                pencil[peer / 9][peer % 9] &= ~bit;
+            }
+        }
+    }
+    boardChanged = true;
+}
+
+// pencil in every digit not yet used in each empty cell's row, column and box
+void Game::fill_pencil_marks() {
+    std::array<uint16_t, 9> rows{}, cols{}, boxes{};
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            if (game[r][c] != unset) {
+                uint16_t bit = 1 << (game[r][c] - 1);
+                rows[r] |= bit;
+                cols[c] |= bit;
+                boxes[(r / 3) * 3 + c / 3] |= bit;
+            }
+        }
+    }
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            pencil[r][c] = game[r][c] != unset ? 0 : allDigits & ~(rows[r] | cols[c] | boxes[(r / 3) * 3 + c / 3]);
+        }
     }
+    boardChanged = true;
 }
 int Game::at_cursor() const {
     return game[cursorY][cursorX];
@@ -338,7 +501,6 @@ void Game::move_cursor(int row, int col) {
     }
     cursorY = row;
     cursorX = col;
-    isPencil2 = false;
 }
 void Game::set_at_cursor(int value, bool isPenciled) {
     set(cursorY, cursorX, value, isPenciled);
@@ -357,4 +519,5 @@ void Game::try_solve() {
 
 void Game::auto_solve() {
     game = solution;
+    boardChanged = true;
 }
\ No newline at end of file
@@ -0,0 +1,436 @@
+#include "logic_solver.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace {
+    struct Tables {
+        // units 0..8 are rows, 9..17 columns, 18..26 boxes
+        std::array<std::array<uint8_t, 9>, 27> units{};
+    };
+
+    constexpr Tables build_tables() {
+        Tables t;
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                t.units[i][j] = i * 9 + j;
+                t.units[9 + i][j] = j * 9 + i;
+                t.units[18 + i][j] = ((i / 3) * 3 + j / 3) * 9 + (i % 3) * 3 + j % 3;
+            }
+        }
+        return t;
+    }
+
+    constexpr Tables tables = build_tables();
+
+    // hardest technique picks the band, weighted step count orders grids within it:
+    // hidden singles only, then naked singles and locked candidates, then
+    // subsets and fish. A grid the techniques cannot finish is scored by how
+    // much they left, so a grid that needs one late guess still rates Hard
+    // and only those where logic stalls early reach Master.
+    constexpr std::array<int, techniqueCount> weights = {1, 2, 10, 12, 15, 20, 30, 35, 40, 60};
+    constexpr std::array<int, techniqueCount> tiers = {0, 1, 1, 1, 2, 2, 2, 2, 2, 2};
+    constexpr std::array<int, 3> bandStart = {0, 401, 801};
+    constexpr std::array<int, 3> bandEnd = {400, 800, 900};
+    constexpr int beyondLogic = 900;
+    constexpr int perRemainingCell = 6;     // 33 cells left still rates Hard, 34 is Master
+
+    // calls f on every `size`-element combination of items until f returns true
+    template <typename F>
+    bool for_each_combo(const int* items, int n, int size, F&& f, int start = 0, int depth = 0, int* chosen = nullptr) {
+        int buffer[9];  // size <= n <= 9
+        if (chosen == nullptr) {
+            chosen = buffer;
+        }
+        if (depth == size) {
+            return f(chosen);
+        }
+        for (int i = start; i <= n - (size - depth); i++) {
+            chosen[depth] = items[i];
+            if (for_each_combo(items, n, size, f, i + 1, depth + 1, chosen)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+const char* technique_str(Technique t) {
+    switch (t) {
+        case Technique::HiddenSingle:
+            return "hidden single";
+        case Technique::NakedSingle:
+            return "naked single";
+        case Technique::Pointing:
+            return "pointing";
+        case Technique::Claiming:
+            return "claiming";
+        case Technique::NakedPair:
+            return "naked pair";
+        case Technique::HiddenPair:
+            return "hidden pair";
+        case Technique::NakedTriple:
+            return "naked triple";
+        case Technique::HiddenTriple:
+            return "hidden triple";
+        case Technique::XWing:
+            return "x-wing";
+        case Technique::Swordfish:
+            return "swordfish";
+        case Technique::Count:
+            break;
+    }
+    return "UNKNOWN";
+}
+
+int logic_difficulty_score(const LogicResult& result) {
+    int weighted = 0;
+    for (int t = 0; t < techniqueCount; t++) {
+        weighted += weights[t] * result.uses[t];
+    }
+    if (!result.solved) {
+        return beyondLogic + perRemainingCell * std::max(1, result.remaining);
+    }
+    int tier = result.hardest < 0 ? 0 : tiers[result.hardest];
+    return std::min(bandStart[tier] + weighted, bandEnd[tier]);
+}
+
+LogicSolver::LogicSolver(const Board& grid, SolverStats* stats) : stats(nullptr) {
+    candidates.fill(allDigits);
+    for (int idx = 0; idx < 81; idx++) {
+        int value = grid.cells[idx];
+        if (value < 1 || value > 9) {
+            continue;
+        }
+        if (!(candidates[idx] & (1 << (value - 1)))) {
+            broken = true;
+        }
+        place(idx, value);
+    }
+    for (int idx = 0; idx < 81; idx++) {
+        if (board.cells[idx] == 0) {
+            result.emptyCells++;
+        }
+    }
+    // attach stats only now so the givens don't count as propagation
+    this->stats = stats;
+}
+
+void LogicSolver::place(int idx, int digit) {
+    uint16_t bit = 1 << (digit - 1);
+    board.cells[idx] = digit;
+    candidates[idx] = 0;
+    if (stats) {
+        stats->propagationSteps++;
+    }
+    for (int peer : peerCells[idx]) {
+        candidates[peer] &= ~bit;
+        if (board.cells[peer] == 0 && candidates[peer] == 0) {
+            broken = true;
+        }
+    }
+}
+
+bool LogicSolver::eliminate(int idx, uint16_t mask) {
+    if (board.cells[idx] != 0 || !(candidates[idx] & mask)) {
+        return false;
+    }
+    candidates[idx] &= ~mask;
+    if (stats) {
+        stats->propagationSteps++;
+    }
+    if (candidates[idx] == 0) {
+        broken = true;
+    }
+    return true;
+}
+
+LogicResult LogicSolver::solve() {
+    auto start = std::chrono::steady_clock::now();
+    int remaining = result.emptyCells;
+    while (remaining > 0 && !broken) {
+        bool progress = false;
+        if (stats) {
+            stats->nodes++;
+        }
+        for (int t = 0; t < techniqueCount; t++) {
+            if (stats) {
+                stats->candidateChecks++;
+            }
+            if (apply(static_cast<Technique>(t))) {
+                result.uses[t]++;
+                result.hardest = std::max(result.hardest, t);
+                progress = true;
+                break;
+            }
+        }
+        if (!progress) {
+            break;
+        }
+        remaining = std::count(board.cells.begin(), board.cells.end(), 0);
+    }
+
+    result.remaining = remaining;
+    result.contradiction = broken;
+    result.solved = remaining == 0 && !broken;
+    result.score = logic_difficulty_score(result);
+    if (stats) {
+        stats->wallTime += std::chrono::steady_clock::now() - start;
+    }
+    return result;
+}
+
+bool LogicSolver::apply(Technique t) {
+    switch (t) {
+        case Technique::HiddenSingle:
+            return hidden_single();
+        case Technique::NakedSingle:
+            return naked_single();
+        case Technique::Pointing:
+            return pointing();
+        case Technique::Claiming:
+            return claiming();
+        case Technique::NakedPair:
+            return naked_subset(2);
+        case Technique::HiddenPair:
+            return hidden_subset(2);
+        case Technique::NakedTriple:
+            return naked_subset(3);
+        case Technique::HiddenTriple:
+            return hidden_subset(3);
+        case Technique::XWing:
+            return fish(2);
+        case Technique::Swordfish:
+            return fish(3);
+        case Technique::Count:
+            break;
+    }
+    return false;
+}
+
+bool LogicSolver::naked_single() {
+    for (int idx = 0; idx < 81; idx++) {
+        if (board.cells[idx] == 0 && std::popcount(candidates[idx]) == 1) {
+            place(idx, std::countr_zero(candidates[idx]) + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogicSolver::hidden_single() {
+    for (const auto& unit : tables.units) {
+        uint16_t once = 0, twice = 0, placed = 0;
+        for (int idx : unit) {
+            if (board.cells[idx] != 0) {
+                placed |= 1 << (board.cells[idx] - 1);
+            } else {
+                twice |= once & candidates[idx];
+                once |= candidates[idx];
+            }
+        }
+        if ((once | placed) != allDigits) {
+            broken = true;
+            return false;
+        }
+        uint16_t exactly = once & ~twice;
+        if (exactly == 0) {
+            continue;
+        }
+        uint16_t bit = exactly & -exactly;
+        for (int idx : unit) {
+            if (candidates[idx] & bit) {
+                place(idx, std::countr_zero(bit) + 1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool LogicSolver::pointing() {
+    for (int box = 0; box < 9; box++) {
+        const auto& unit = tables.units[18 + box];
+        for (int d = 0; d < 9; d++) {
+            uint16_t bit = 1 << d;
+            int rows = 0, cols = 0;
+            for (int idx : unit) {
+                if (candidates[idx] & bit) {
+                    rows |= 1 << (idx / 9);
+                    cols |= 1 << (idx % 9);
+                }
+            }
+            bool changed = false;
+            if (std::popcount(static_cast<unsigned>(rows)) == 1) {
+                for (int idx : tables.units[std::countr_zero(static_cast<unsigned>(rows))]) {
+                    if (boxOf(idx) != box) {
+                        changed |= eliminate(idx, bit);
+                    }
+                }
+            }
+            if (std::popcount(static_cast<unsigned>(cols)) == 1) {
+                for (int idx : tables.units[9 + std::countr_zero(static_cast<unsigned>(cols))]) {
+                    if (boxOf(idx) != box) {
+                        changed |= eliminate(idx, bit);
+                    }
+                }
+            }
+            if (changed) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool LogicSolver::claiming() {
+    for (int line = 0; line < 18; line++) {
+        const auto& unit = tables.units[line];
+        for (int d = 0; d < 9; d++) {
+            uint16_t bit = 1 << d;
+            int boxes = 0;
+            for (int idx : unit) {
+                if (candidates[idx] & bit) {
+                    boxes |= 1 << boxOf(idx);
+                }
+            }
+            if (std::popcount(static_cast<unsigned>(boxes)) != 1) {
+                continue;
+            }
+            bool changed = false;
+            for (int idx : tables.units[18 + std::countr_zero(static_cast<unsigned>(boxes))]) {
+                bool inLine = line < 9 ? idx / 9 == line : idx % 9 == line - 9;
+                if (!inLine) {
+                    changed |= eliminate(idx, bit);
+                }
+            }
+            if (changed) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool LogicSolver::naked_subset(int size) {
+    for (const auto& unit : tables.units) {
+        int items[9], n = 0;
+        for (int idx : unit) {
+            int count = std::popcount(candidates[idx]);
+            if (board.cells[idx] == 0 && count >= 2 && count <= size) {
+                items[n++] = idx;
+            }
+        }
+        bool changed = for_each_combo(items, n, size, [&](const int* chosen) {
+            uint16_t mask = 0;
+            for (int i = 0; i < size; i++) {
+                mask |= candidates[chosen[i]];
+            }
+            if (std::popcount(mask) != size) {
+                return false;
+            }
+            bool any = false;
+            for (int idx : unit) {
+                if (std::find(chosen, chosen + size, idx) == chosen + size) {
+                    any |= eliminate(idx, mask);
+                }
+            }
+            return any;
+        });
+        if (changed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogicSolver::hidden_subset(int size) {
+    for (const auto& unit : tables.units) {
+        // positions[d] is a 9-bit mask of where digit d can still go in this unit
+        uint16_t positions[9] = {};
+        for (int pos = 0; pos < 9; pos++) {
+            for (int d = 0; d < 9; d++) {
+                if (candidates[unit[pos]] & (1 << d)) {
+                    positions[d] |= 1 << pos;
+                }
+            }
+        }
+        int items[9], n = 0;
+        for (int d = 0; d < 9; d++) {
+            int count = std::popcount(positions[d]);
+            if (count >= 2 && count <= size) {
+                items[n++] = d;
+            }
+        }
+        bool changed = for_each_combo(items, n, size, [&](const int* chosen) {
+            uint16_t where = 0, digits = 0;
+            for (int i = 0; i < size; i++) {
+                where |= positions[chosen[i]];
+                digits |= 1 << chosen[i];
+            }
+            if (std::popcount(where) != size) {
+                return false;
+            }
+            bool any = false;
+            for (int pos = 0; pos < 9; pos++) {
+                if (where & (1 << pos)) {
+                    any |= eliminate(unit[pos], allDigits & ~digits);
+                }
+            }
+            return any;
+        });
+        if (changed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LogicSolver::fish(int size) {
+    for (int d = 0; d < 9; d++) {
+        uint16_t bit = 1 << d;
+        // base 0 uses rows as the base set and eliminates in columns, base 1 the reverse
+        for (int base = 0; base < 2; base++) {
+            uint16_t lines[9] = {};
+            for (int idx = 0; idx < 81; idx++) {
+                if (candidates[idx] & bit) {
+                    int line = base == 0 ? idx / 9 : idx % 9;
+                    int cover = base == 0 ? idx % 9 : idx / 9;
+                    lines[line] |= 1 << cover;
+                }
+            }
+            int items[9], n = 0;
+            for (int line = 0; line < 9; line++) {
+                int count = std::popcount(lines[line]);
+                if (count >= 2 && count <= size) {
+                    items[n++] = line;
+                }
+            }
+            bool changed = for_each_combo(items, n, size, [&](const int* chosen) {
+                uint16_t covers = 0, baseLines = 0;
+                for (int i = 0; i < size; i++) {
+                    covers |= lines[chosen[i]];
+                    baseLines |= 1 << chosen[i];
+                }
+                if (std::popcount(covers) != size) {
+                    return false;
+                }
+                bool any = false;
+                for (int cover = 0; cover < 9; cover++) {
+                    if (!(covers & (1 << cover))) {
+                        continue;
+                    }
+                    for (int line = 0; line < 9; line++) {
+                        if (!(baseLines & (1 << line))) {
+                            any |= eliminate(base == 0 ? line * 9 + cover : cover * 9 + line, bit);
+                        }
+                    }
+                }
+                return any;
+            });
+            if (changed) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
\ No newline at end of file
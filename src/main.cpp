@@ -1,7 +1,11 @@
 #include "game.hpp"
+#include "commands.hpp"
 #include <memory>
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return run_command(argc, argv);
+    }
     auto game = std::make_unique<Game>();
     game->start();
     return 0;
@@ -0,0 +1,238 @@
+#include "minimal_generator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+#include "bit_solver.hpp"
+
+namespace {
+    // cells that are removed together with idx under the symmetry (idx first)
+    int orbit(int idx, Symmetry symmetry, int out[4]) {
+        int r = idx / 9, c = idx % 9, n = 0;
+        out[n++] = idx;
+        auto add = [&](int cell) {
+            if (std::find(out, out + n, cell) == out + n) {
+                out[n++] = cell;
+            }
+        };
+        switch (symmetry) {
+            case Symmetry::None:
+                break;
+            case Symmetry::Rotational:
+                add(80 - idx);
+                break;
+            case Symmetry::Diagonal:
+                add(c * 9 + r);
+                break;
+            case Symmetry::Quarter:
+                add(c * 9 + (8 - r));
+                add(80 - idx);
+                add((8 - c) * 9 + r);
+                break;
+        }
+        return n;
+    }
+
+    bool has_symmetry(const Board& puzzle, Symmetry symmetry) {
+        int cells[4];
+        for (int idx = 0; idx < 81; idx++) {
+            int n = orbit(idx, symmetry, cells);
+            for (int i = 1; i < n; i++) {
+                if ((puzzle.cells[cells[i]] != 0) != (puzzle.cells[idx] != 0)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // removes the given cells if the puzzle stays unique, otherwise leaves it untouched
+    bool try_remove(Board& puzzle, const Board& solution, const int* cells, int n) {
+        for (int i = 0; i < n; i++) {
+            puzzle.cells[cells[i]] = 0;
+        }
+        BitSolver solver(puzzle);
+        bool unique;
+        if (n == 1) {
+            // puzzle was unique before, so it still is unless another digit fits here
+            solver.forbid(cells[0] / 9, cells[0] % 9, solution.cells[cells[0]]);
+            Board other;
+            unique = !solver.solve(other);
+        } else {
+            unique = solver.count(2) == 1;
+        }
+        if (!unique) {
+            for (int i = 0; i < n; i++) {
+                puzzle.cells[cells[i]] = solution.cells[cells[i]];
+            }
+        }
+        return unique;
+    }
+
+    int clue_count(const Board& puzzle) {
+        return 81 - std::count(puzzle.cells.begin(), puzzle.cells.end(), 0);
+    }
+
+    // true if no single clue of puzzle (unique, with this solution) can go
+    bool every_clue_needed(Board puzzle, const Board& solution) {
+        int cells[1];
+        for (int idx = 0; idx < 81; idx++) {
+            cells[0] = idx;
+            if (puzzle.cells[idx] != 0 && try_remove(puzzle, solution, cells, 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // one removal order; returns false if stopped before the puzzle was orbit-minimal
+    template <typename Stop>
+    bool reduce(Board& puzzle, const Board& solution, std::mt19937_64& rng, Symmetry symmetry, Stop&& stop) {
+        std::array<int, 81> order;
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+
+        // a clue (or orbit) kept here stays necessary as later ones go, so one
+        // pass is enough; with a symmetry whole orbits come out together, which
+        // leaves the puzzle orbit-minimal but not necessarily minimal
+        int cells[4];
+        for (int idx : order) {
+            if (stop()) {
+                return false;
+            }
+            if (puzzle.cells[idx] != 0) {
+                try_remove(puzzle, solution, cells, orbit(idx, symmetry, cells));
+            }
+        }
+        return true;
+    }
+
+    bool better(const MinimalResult& a, const MinimalResult& b) {
+        if (a.symmetric != b.symmetric) {
+            return a.symmetric;
+        }
+        if (a.minimal != b.minimal) {
+            return a.minimal;
+        }
+        if (a.orbitMinimal != b.orbitMinimal) {
+            return a.orbitMinimal;
+        }
+        return a.clues < b.clues;
+    }
+}
+
+MinimalResult generate_minimal(const Board& solution, const MinimalOptions& options, const GenBudget& budget) {
+    int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    int attempts = options.attempts;
+    if (attempts <= 0) {
+        attempts = options.targetClues > 0 ? 4096 : (options.symmetry != Symmetry::None ? 1024 : threads);
+    }
+    threads = std::min(threads, attempts);
+    uint64_t seed = options.seed != 0 ? options.seed : std::random_device()();
+
+    MinimalResult best;
+    best.puzzle = solution;
+    best.symmetric = true;
+    best.attempts = 0;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    int running = threads;
+    std::atomic<int> started{0};
+    std::atomic<bool> done{false};
+    bool cancelled = false;
+
+    auto stop = [&] {
+        if (done.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (budget.cancel != nullptr && budget.cancel->cancelled()) {
+            done = true;
+        } else if (std::chrono::steady_clock::now() >= budget.deadline) {
+            done = true;
+        }
+        return done.load(std::memory_order_relaxed);
+    };
+
+    auto worker = [&](int index) {
+        std::mt19937_64 rng(seed + 0x9E3779B97F4A7C15ULL * (index + 1));
+        while (started.fetch_add(1) < attempts && !stop()) {
+            MinimalResult attempt;
+            attempt.puzzle = solution;
+            attempt.orbitMinimal = reduce(attempt.puzzle, solution, rng, options.symmetry, stop);
+            attempt.minimal = attempt.orbitMinimal
+                && (options.symmetry == Symmetry::None || every_clue_needed(attempt.puzzle, solution));
+            attempt.clues = clue_count(attempt.puzzle);
+            attempt.symmetric = has_symmetry(attempt.puzzle, options.symmetry);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            best.attempts++;
+            if (best.attempts == 1 || better(attempt, best)) {
+                attempt.attempts = best.attempts;
+                best = attempt;
+            }
+            if (options.targetClues > 0 && best.minimal && best.symmetric && best.clues <= options.targetClues) {
+                done = true;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        running--;
+        finished.notify_one();
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(worker, i);
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running > 0) {
+            finished.wait_for(lock, std::chrono::milliseconds(50));
+            if (budget.onProgress) {
+                GenProgress progress;
+                progress.cluesRemoved = 81 - best.clues;
+                progress.positionsTried = best.attempts;
+                lock.unlock();
+                budget.onProgress(progress);
+                lock.lock();
+            }
+        }
+        cancelled = budget.cancel != nullptr && budget.cancel->cancelled();
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    bool reachedTarget = options.targetClues == 0
+        ? best.minimal && best.symmetric
+        : best.minimal && best.symmetric && best.clues <= options.targetClues;
+    if (cancelled) {
+        best.status = GenStatus::Cancelled;
+    } else {
+        best.status = reachedTarget ? GenStatus::Complete : GenStatus::OutOfBudget;
+    }
+    return best;
+}
+
+bool is_minimal(const Board& puzzle) {
+    if (BitSolver(puzzle).count(2) != 1) {
+        return false;
+    }
+    Board copy = puzzle;
+    for (int idx = 0; idx < 81; idx++) {
+        if (puzzle.cells[idx] == 0) {
+            continue;
+        }
+        copy.cells[idx] = 0;
+        bool unique = BitSolver(copy).count(2) == 1;
+        copy.cells[idx] = puzzle.cells[idx];
+        if (unique) {
+            return false;
+        }
+    }
+    return true;
+}
\ No newline at end of file
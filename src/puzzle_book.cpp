@@ -0,0 +1,215 @@
+#include "puzzle_book.hpp"
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    constexpr int cellSize = 50;
+    constexpr int gridSize = cellSize * 9;
+    constexpr int slotWidth = gridSize + 50;
+    constexpr int slotHeight = gridSize + 80;
+    const std::string heightPlaceholder = "0000000000";
+
+    void append(std::string& s, int value) {
+        char digits[12];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        s.append(digits, end);
+    }
+
+    std::string builtin_grid() {
+        std::string s = "<rect x=\"0\" y=\"0\" width=\"450\" height=\"450\" fill=\"white\" stroke=\"black\" stroke-width=\"4\"/>\n";
+        for (int i = 1; i < 9; i++) {
+            const char* width = i % 3 == 0 ? "3" : "1";
+            int at = i * cellSize;
+            s += "<line x1=\"";
+            append(s, at);
+            s += "\" y1=\"0\" x2=\"";
+            append(s, at);
+            s += "\" y2=\"450\" stroke=\"black\" stroke-width=\"";
+            s += width;
+            s += "\"/>\n<line x1=\"0\" y1=\"";
+            append(s, at);
+            s += "\" x2=\"450\" y2=\"";
+            append(s, at);
+            s += "\" stroke=\"black\" stroke-width=\"";
+            s += width;
+            s += "\"/>\n";
+        }
+        return s;
+    }
+
+    // svgHead.txt holds a whole <svg> opening plus the grid lines; keep just the drawing
+    std::string load_grid(const std::string& dir) {
+        std::ifstream file(dir + "svgHead.txt");
+        if (!file) {
+            return builtin_grid();
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        std::string head = contents.str();
+        auto open = head.find("<svg");
+        if (open != std::string::npos) {
+            head.erase(0, head.find('>', open) + 1);
+        }
+        auto close = head.rfind("</svg>");
+        if (close != std::string::npos) {
+            head.erase(close);
+        }
+        return head;
+    }
+}
+
+PuzzleBook::PuzzleBook(std::ostream& out, BookOptions options) : out(out), options(std::move(options)) {
+    if (this->options.perPage < 1) {
+        this->options.perPage = 1;
+    }
+    if (this->options.columns < 1) {
+        this->options.columns = 1;
+    }
+    if (this->options.format == BookFormat::Svg) {
+        gridBody = load_grid(this->options.templatePath);
+    }
+    page.reserve(this->options.perPage);
+}
+
+PuzzleBook::~PuzzleBook() {
+    finish();
+}
+
+void PuzzleBook::add(const Board& puzzle, int difficultyLevel, const Board& solution) {
+    page.push_back({puzzle, solution, difficultyLevel});
+    if (static_cast<int>(page.size()) == options.perPage) {
+        flush_page();
+    }
+}
+
+void PuzzleBook::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+    if (!page.empty() || !started) {
+        flush_page();
+    }
+    if (options.format == BookFormat::Svg) {
+        out << "</svg>\n";
+        if (heightPos != std::streampos(-1)) {
+            auto end = out.tellp();
+            std::string height = std::to_string(pageCount * page_height());
+            height.insert(0, heightPlaceholder.size() - height.size(), '0');
+            out.seekp(heightPos);
+            out.write(height.data(), height.size());
+            out.seekp(end);
+        }
+    }
+    out.flush();
+}
+
+void PuzzleBook::flush_page() {
+    if (!started && options.format == BookFormat::Svg) {
+        write_svg_header();
+    }
+    started = true;
+
+    for (int i = 0; i < (options.solutions ? 2 : 1); i++) {
+        if (options.format == BookFormat::Svg) {
+            write_svg_page(i == 1);
+        } else {
+            write_text_page(i == 1);
+        }
+        pageCount++;
+    }
+
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+    puzzleCount += page.size();
+    page.clear();
+}
+
+int PuzzleBook::page_height() const {
+    return (options.perPage + options.columns - 1) / options.columns * slotHeight;
+}
+
+void PuzzleBook::write_svg_header() {
+    buffer += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"";
+    append(buffer, options.columns * slotWidth);
+    buffer += "\" height=\"";
+    if (options.expectedPuzzles > 0) {
+        int pages = (options.expectedPuzzles + options.perPage - 1) / options.perPage * (options.solutions ? 2 : 1);
+        append(buffer, pages * page_height());
+    } else if (auto pos = out.tellp(); pos != std::streampos(-1)) {
+        // height is only known at the end; leave a fixed-width number to patch in finish()
+        heightPos = pos + std::streamoff(buffer.size());
+        buffer += heightPlaceholder;
+    } else {
+        buffer += "100%";
+    }
+    buffer += "\">\n";
+}
+
+void PuzzleBook::write_svg_page(bool solutions) {
+    buffer += "<svg y=\"";
+    append(buffer, pageCount * page_height());
+    buffer += "\" width=\"";
+    append(buffer, options.columns * slotWidth);
+    buffer += "\" height=\"";
+    append(buffer, page_height());
+    buffer += "\">\n";
+
+    for (size_t n = 0; n < page.size(); n++) {
+        const Entry& entry = page[n];
+        buffer += "<g transform=\"translate(";
+        append(buffer, static_cast<int>(n % options.columns) * slotWidth + 25);
+        buffer += ",";
+        append(buffer, static_cast<int>(n / options.columns) * slotHeight + 25);
+        buffer += ")\">\n";
+        buffer += gridBody;
+
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                bool given = entry.puzzle[i][j] != 0;
+                int value = given ? entry.puzzle[i][j] : (solutions ? entry.solution[i][j] : 0);
+                if (value == 0) {
+                    continue;
+                }
+                buffer += "<text x=\"";
+                append(buffer, cellSize * j + 16);
+                buffer += "\" y=\"";
+                append(buffer, cellSize * i + 35);
+                buffer += given ? "\" style=\"font-weight:bold\" font-size=\"30px\">" : "\" fill=\"gray\" font-size=\"30px\">";
+                append(buffer, value);
+                buffer += "</text>\n";
+            }
+        }
+
+        buffer += "<text x=\"0\" y=\"480\" style=\"font-weight:bold\" font-size=\"15px\">";
+        buffer += solutions ? "Solution " : "Puzzle ";
+        append(buffer, puzzleCount + static_cast<int>(n) + 1);
+        buffer += " -- Difficulty Level (0 being easiest): ";
+        append(buffer, entry.difficultyLevel);
+        buffer += "</text>\n</g>\n";
+    }
+    buffer += "</svg>\n";
+}
+
+void PuzzleBook::write_text_page(bool solutions) {
+    if (pageCount > 0) {
+        buffer += '\f';
+    }
+    for (size_t n = 0; n < page.size(); n++) {
+        const Entry& entry = page[n];
+        buffer += solutions ? "# solution " : "# puzzle ";
+        append(buffer, puzzleCount + static_cast<int>(n) + 1);
+        buffer += ", difficulty ";
+        append(buffer, entry.difficultyLevel);
+        buffer += '\n';
+        const Board& grid = solutions ? entry.solution : entry.puzzle;
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                buffer += grid[i][j] ? static_cast<char>('0' + grid[i][j]) : '.';
+            }
+            buffer += '\n';
+        }
+        buffer += '\n';
+    }
+}
\ No newline at end of file
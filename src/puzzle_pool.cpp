@@ -0,0 +1,101 @@
+#include "puzzle_pool.hpp"
+#include <algorithm>
+#include <random>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+PuzzlePool::PuzzlePool(size_t capacity, int threads, const DifficultyThresholds& thresholds)
+    : capacity(capacity), thresholds(thresholds) {
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    std::random_device seed;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&PuzzlePool::generate, this, (uint64_t(seed()) << 32) | seed());
+    }
+}
+
+PuzzlePool::~PuzzlePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop.cancel();
+    }
+    space.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    close(eventFd);
+}
+
+bool PuzzlePool::take(Difficulty d, PooledPuzzle& out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& pool = pools[static_cast<int>(d)];
+    if (pool.empty()) {
+        // someone wants this band after all, so try it again
+        if (misses[static_cast<int>(d)] >= PoolConstants::giveUpAfter) {
+            misses[static_cast<int>(d)] = 0;
+            space.notify_all();
+        }
+        return false;
+    }
+    out = pool.front();
+    pool.pop_front();
+    space.notify_one();
+    return true;
+}
+
+size_t PuzzlePool::size(Difficulty d) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pools[static_cast<int>(d)].size();
+}
+
+void PuzzlePool::drain_notifications() {
+    uint64_t count;
+    while (read(eventFd, &count, sizeof(count)) == sizeof(count)) {
+    }
+}
+
+// caller holds mutex
+bool PuzzlePool::wants_more() const {
+    for (int d = 0; d < difficultyCount; d++) {
+        if (pools[d].size() < capacity && misses[d] < PoolConstants::giveUpAfter) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PuzzlePool::generate(uint64_t seed) {
+    GenBudget budget;
+    budget.cancel = &stop;
+    for (uint64_t n = 0;; n++) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            space.wait(lock, [this] { return stop.cancelled() || wants_more(); });
+            if (stop.cancelled()) {
+                return;
+            }
+        }
+
+        Sudoku puzzle(seed + n);
+        if (puzzle.createSeed(budget) != GenStatus::Complete || puzzle.genPuzzle(budget) != GenStatus::Complete) {
+            continue;   // only cancellation stops these, so we are shutting down
+        }
+        puzzle.calculateDifficulty();
+
+        PooledPuzzle entry;
+        entry.puzzle = PackedBoard(puzzle.grid);
+        entry.solution = PackedBoard(puzzle.solnGrid);
+        entry.difficultyLevel = puzzle.difficultyLevel;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        int band = static_cast<int>(classify_difficulty(puzzle.difficultyLevel, thresholds));
+        for (int d = 0; d < difficultyCount; d++) {
+            misses[d] = d == band ? 0 : std::min(misses[d] + 1, PoolConstants::giveUpAfter);
+        }
+        auto& pool = pools[band];
+        if (pool.size() < capacity) {
+            pool.push_back(entry);
+            uint64_t one = 1;
+            (void)!write(eventFd, &one, sizeof(one));
+        }
+    }
+}
\ No newline at end of file
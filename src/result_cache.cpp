@@ -0,0 +1,269 @@
+#include "result_cache.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bit_solver.hpp"
+#include "logic_solver.hpp"
+
+namespace {
+    struct CacheHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t scoreVersion;  // logicScoreVersion of every difficultyLevel in the file
+        uint32_t reserved;
+    };
+    static_assert(sizeof(CacheHeader) == 16);
+
+    // on-disk form of one result, two 41-byte packed boards plus the numbers
+    struct CacheRecord {
+        uint64_t hash;
+        PackedBoard puzzle;
+        PackedBoard solution;
+        uint8_t solutions;
+        uint8_t reserved;
+        int32_t difficultyLevel;
+    };
+    static_assert(sizeof(CacheRecord) == 96);
+
+    CachedResult unpack(const CacheRecord& record) {
+        CachedResult result;
+        result.solution = record.solution.unpack();
+        result.solutions = record.solutions;
+        result.difficultyLevel = record.difficultyLevel;
+        return result;
+    }
+}
+
+ResultCache::ResultCache(const std::filesystem::path& path, size_t capacity)
+    : shardCapacity(std::max<size_t>(1, capacity / CacheConstants::shards)) {
+    if (!path.empty() && !open_file(path) && fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+ResultCache::~ResultCache() {
+    if (mapped) {
+        munmap(const_cast<uint8_t*>(mapped), mappedSize);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool ResultCache::open_file(const std::filesystem::path& path) {
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        return false;
+    }
+
+    struct stat st;
+    CacheHeader header{};
+    bool valid = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(header)
+        && pread(fd, &header, sizeof(header), 0) == sizeof(header)
+        && header.magic == CacheConstants::magic
+        && header.version == CacheConstants::version
+        && header.recordSize == sizeof(CacheRecord)
+        && header.scoreVersion == logicScoreVersion;
+    if (valid) {
+        // a crash mid-append can leave a partial record at the end; drop it
+        fileSize = sizeof(header) + (st.st_size - sizeof(header)) / sizeof(CacheRecord) * sizeof(CacheRecord);
+        if (static_cast<off_t>(fileSize) != st.st_size && ftruncate(fd, fileSize) != 0) {
+            return false;
+        }
+    } else {
+        // unreadable, from another version or graded differently: it is only a cache, start over
+        header = {CacheConstants::magic, CacheConstants::version, sizeof(CacheRecord), logicScoreVersion, 0};
+        if (ftruncate(fd, 0) != 0 || pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            return false;
+        }
+        fileSize = sizeof(header);
+    }
+
+    remap();
+    if (!mapped) {
+        return false;
+    }
+    for (uint64_t offset = sizeof(header); offset < fileSize; offset += sizeof(CacheRecord)) {
+        uint64_t hash;
+        std::memcpy(&hash, mapped + offset, sizeof(hash));
+        diskIndex[hash] = offset;
+    }
+    return true;
+}
+
+// caller holds diskMutex exclusively
+void ResultCache::remap() {
+    if (mapped) {
+        munmap(const_cast<uint8_t*>(mapped), mappedSize);
+        mapped = nullptr;
+        mappedSize = 0;
+    }
+    void* address = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (address != MAP_FAILED) {
+        mapped = static_cast<const uint8_t*>(address);
+        mappedSize = fileSize;
+    }
+}
+
+CachedResult ResultCache::get(const Board& puzzle) {
+    if (auto cached = find(puzzle)) {
+        return *cached;
+    }
+    return compute(puzzle);
+}
+
+CachedResult ResultCache::compute(const Board& puzzle) {
+    CachedResult result;
+    BitSolver counter(puzzle);
+    result.solutions = counter.valid() ? counter.count(2) : 0;
+    if (result.solutions > 0) {
+        BitSolver(puzzle).solve(result.solution);
+    }
+    result.difficultyLevel = LogicSolver(puzzle).solve().score;
+    insert(puzzle, result);
+    return result;
+}
+
+std::optional<CachedResult> ResultCache::find(const Board& puzzle) {
+    uint64_t hash = puzzle.hash();
+    PackedBoard packed(puzzle);
+    if (auto result = find_memory(hash, packed)) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+    if (auto result = find_disk(hash, packed)) {
+        diskHits.fetch_add(1, std::memory_order_relaxed);
+        remember(hash, packed, *result);
+        return result;
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void ResultCache::insert(const Board& puzzle, const CachedResult& result) {
+    uint64_t hash = puzzle.hash();
+    PackedBoard packed(puzzle);
+    remember(hash, packed, result);
+    append(hash, packed, result);
+}
+
+std::optional<CachedResult> ResultCache::find_memory(uint64_t hash, const PackedBoard& packed) {
+    auto& shard = shards[hash % CacheConstants::shards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(hash);
+    if (it == shard.index.end() || it->second->puzzle != packed) {
+        return std::nullopt;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return it->second->result;
+}
+
+std::optional<CachedResult> ResultCache::find_disk(uint64_t hash, const PackedBoard& packed) {
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    CacheRecord record;
+    uint64_t offset;
+    bool read = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(diskMutex);
+        auto it = diskIndex.find(hash);
+        if (it == diskIndex.end()) {
+            return std::nullopt;
+        }
+        offset = it->second;
+        if (offset + sizeof(record) <= mappedSize) {
+            std::memcpy(&record, mapped + offset, sizeof(record));
+            read = true;
+        }
+    }
+    if (!read) {
+        // appended since the file was last mapped; records never move, so
+        // the offset is still good once the mapping has caught up
+        std::unique_lock<std::shared_mutex> lock(diskMutex);
+        if (offset + sizeof(record) > mappedSize) {
+            remap();
+        }
+        if (!mapped || offset + sizeof(record) > mappedSize) {
+            return std::nullopt;
+        }
+        std::memcpy(&record, mapped + offset, sizeof(record));
+    }
+    if (record.puzzle != packed) {
+        return std::nullopt;
+    }
+    return unpack(record);
+}
+
+void ResultCache::remember(uint64_t hash, const PackedBoard& packed, const CachedResult& result) {
+    auto& shard = shards[hash % CacheConstants::shards];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto it = shard.index.find(hash); it != shard.index.end()) {
+        it->second->puzzle = packed;
+        it->second->result = result;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return;
+    }
+    shard.entries.push_front({hash, packed, result});
+    shard.index[hash] = shard.entries.begin();
+    if (shard.entries.size() > shardCapacity) {
+        shard.index.erase(shard.entries.back().hash);
+        shard.entries.pop_back();
+    }
+}
+
+void ResultCache::append(uint64_t hash, const PackedBoard& packed, const CachedResult& result) {
+    if (fd < 0) {
+        return;
+    }
+    CacheRecord record{};
+    record.hash = hash;
+    record.puzzle = packed;
+    record.solution = PackedBoard(result.solution);
+    record.solutions = static_cast<uint8_t>(result.solutions);
+    record.difficultyLevel = result.difficultyLevel;
+
+    // two threads missing on the same puzzle at once both append it; the
+    // index just points at the later copy
+    std::unique_lock<std::shared_mutex> lock(diskMutex);
+    if (pwrite(fd, &record, sizeof(record), fileSize) != sizeof(record)) {
+        return;
+    }
+    diskIndex[hash] = fileSize;
+    fileSize += sizeof(record);
+    appends.fetch_add(1, std::memory_order_relaxed);
+}
+
+ResultCacheStats ResultCache::stats() const {
+    ResultCacheStats result;
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.diskHits = diskHits.load(std::memory_order_relaxed);
+    result.misses = misses.load(std::memory_order_relaxed);
+    result.appends = appends.load(std::memory_order_relaxed);
+    if (fd >= 0) {
+        std::shared_lock<std::shared_mutex> lock(diskMutex);
+        result.records = (fileSize - sizeof(CacheHeader)) / sizeof(CacheRecord);
+    }
+    return result;
+}
+
+std::filesystem::path default_cache_path() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::filesystem::path(xdg) / "sudokurse" / "results.cache";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path(home) / ".cache" / "sudokurse" / "results.cache";
+    }
+    return "results.cache";
+}
@@ -0,0 +1,177 @@
+#include "savegame.hpp"
+#include "difficulty.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // version 1 kept two pencil digits per cell as boards of their own
+    struct SaveStateV1 {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t difficulty;
+        uint8_t isPencil2;
+        uint32_t elapsedSeconds;
+        uint8_t cursorY;
+        uint8_t cursorX;
+        Board game;
+        Board penciled1;
+        Board penciled2;
+        Board initialState;
+        Board solution;
+    };
+    static_assert(sizeof(SaveStateV1) == 420);
+
+    SaveState upgrade(const SaveStateV1& old) {
+        SaveState state;
+        state.difficulty = old.difficulty;
+        state.elapsedSeconds = old.elapsedSeconds;
+        state.cursorY = old.cursorY;
+        state.cursorX = old.cursorX;
+        for (int i = 0; i < 81; i++) {
+            for (uint8_t digit : {old.penciled1.cells[i], old.penciled2.cells[i]}) {
+                if (digit >= 1 && digit <= 9) {
+                    state.pencil[i] |= 1 << (digit - 1);
+                }
+            }
+        }
+        state.game = old.game;
+        state.initialState = old.initialState;
+        state.solution = old.solution;
+        return state;
+    }
+}
+
+std::filesystem::path state_dir() {
+    if (const char* xdg = std::getenv("XDG_STATE_HOME"); xdg && *xdg) {
+        return std::filesystem::path(xdg) / "sudokurse";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::filesystem::path(home) / ".local" / "state" / "sudokurse";
+    }
+    return ".";
+}
+
+std::filesystem::path default_save_path() {
+    return state_dir() / "save.bin";
+}
+
+bool write_save(const std::filesystem::path& path, const SaveState& state) {
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&state), sizeof(state));
+        out.flush();
+        if (!out) {
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+std::optional<SaveState> read_save(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+    // big enough for either version; both start with magic and version
+    char buffer[std::max(sizeof(SaveState), sizeof(SaveStateV1))];
+    in.read(buffer, sizeof(buffer));
+    size_t size = in.gcount();
+    uint16_t version = 0;
+    if (size >= offsetof(SaveState, version) + sizeof(version)) {
+        std::memcpy(&version, buffer + offsetof(SaveState, version), sizeof(version));
+    }
+    SaveState state;
+    if (version == 1 && size >= sizeof(SaveStateV1)) {
+        SaveStateV1 old;
+        std::memcpy(&old, buffer, sizeof(old));
+        state = upgrade(old);
+        state.magic = old.magic;
+    } else if (size >= sizeof(SaveState)) {
+        std::memcpy(&state, buffer, sizeof(state));
+    } else {
+        return std::nullopt;
+    }
+    if (state.magic != SaveConstants::magic
+        || state.version != SaveConstants::version
+        || state.difficulty >= difficultyCount) {
+        return std::nullopt;
+    }
+    for (uint16_t marks : state.pencil) {
+        if (marks > allDigits) {
+            return std::nullopt;
+        }
+    }
+    for (const auto* board : {&state.game, &state.initialState, &state.solution}) {
+        for (uint8_t value : board->cells) {
+            if (value > 9) {
+                return std::nullopt;
+            }
+        }
+    }
+    return state;
+}
+
+Autosaver::Autosaver(std::filesystem::path path, std::chrono::milliseconds delay)
+    : path(std::move(path)), delay(delay), worker(&Autosaver::run, this) {}
+
+Autosaver::~Autosaver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_one();
+    worker.join();
+}
+
+void Autosaver::schedule(const SaveState& state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = state;
+        hasPending = true;
+        lastChange = std::chrono::steady_clock::now();
+    }
+    cv.notify_one();
+}
+
+void Autosaver::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return hasPending || stopping; });
+        if (!hasPending) {
+            return;
+        }
+
+        // debounce: keep waiting while new snapshots keep arriving
+        if (!stopping) {
+            auto due = lastChange + delay;
+            if (cv.wait_until(lock, due, [this] { return stopping; }) == false
+                && std::chrono::steady_clock::now() < lastChange + delay) {
+                continue;
+            }
+        }
+
+        SaveState state = pending;
+        hasPending = false;
+        bool stop = stopping;
+        lock.unlock();
+        write_save(path, state);
+        lock.lock();
+        if (stop && !hasPending) {
+            return;
+        }
+    }
+}
\ No newline at end of file
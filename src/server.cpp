@@ -0,0 +1,560 @@
+// sudokurse-server: serves puzzles from in-memory pools over a Unix domain
+// socket. One request per line, one response line per request:
+//
+//   GET <easy|medium|hard|master>  -> OK <puzzle> <solution> <difficultyLevel>
+//   VALIDATE <grid>                -> OK <solutions, capped at 2> <complete 0|1>
+//   SOLVE <grid>                   -> OK <solution>       or ERR no solution
+//   STATS                          -> OK requests=... rps=... p50_us=... ...
+//
+// Grids are 81 characters, row-major, '0' or '.' for empty cells. GET is
+// answered straight from the pool, or as soon as a generator refills it; a
+// GET still waiting after getTimeout gets "ERR timeout".
+// VALIDATE and SOLVE results go through a ResultCache that persists across
+// restarts, and every puzzle handed out by GET is added to it. A grid the
+// cache does not know is solved and graded on one of the --solvers threads,
+// so it never holds up the event loop. Replies always come back in the order
+// the requests were sent.
+//
+// usage: sudokurse-server [--socket PATH] [--pool N] [--threads N] [--solvers N] [--cache FILE | --no-cache]
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "puzzle_pool.hpp"
+#include "result_cache.hpp"
+
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr auto getTimeout = std::chrono::seconds(2);
+
+    // service time of the most recent requests, for percentiles
+    class LatencyLog {
+    public:
+        void add(Clock::duration latency) {
+            samples[total % samples.size()] = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+            total++;
+        }
+
+        std::string report() const {
+            std::vector<long long> sorted(samples.begin(), samples.begin() + std::min<size_t>(total, samples.size()));
+            std::sort(sorted.begin(), sorted.end());
+            auto pct = [&](double p) {
+                return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+            };
+            double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+            return "requests=" + std::to_string(total) + " rps=" + std::to_string(static_cast<long long>(total / seconds))
+                + " p50_us=" + std::to_string(pct(0.50)) + " p90_us=" + std::to_string(pct(0.90))
+                + " p99_us=" + std::to_string(pct(0.99)) + " max_us=" + std::to_string(sorted.empty() ? 0 : sorted.back());
+        }
+
+        long long count() const { return total; }
+
+    private:
+        std::vector<long long> samples = std::vector<long long>(1 << 16);
+        long long total = 0;
+        Clock::time_point started = Clock::now();
+    };
+
+    struct Connection {
+        int fd;
+        uint64_t id;                // fds get reused, ids never do
+        std::string in{};
+        std::string out{};
+        uint32_t watching = EPOLLIN | EPOLLRDHUP;
+        bool closing = false;       // client has stopped sending; close once it has every reply
+        // one slot per request still owed a reply, in request order
+        std::deque<std::optional<std::string>> replies{};
+        uint64_t firstReply = 0;    // request number of replies.front()
+    };
+
+    struct PendingGet {
+        int fd;
+        uint64_t reply;
+        Clock::time_point received;
+    };
+
+    enum class Lookup { Validate, Solve };
+
+    // a VALIDATE / SOLVE the cache could not answer, and where its reply goes
+    struct LookupJob {
+        int fd;
+        uint64_t connection;
+        uint64_t reply;
+        Clock::time_point received;
+        Lookup kind;
+        Board grid;
+        std::string line;           // the reply, filled in by the worker
+    };
+
+    std::string lookup_line(Lookup kind, const Board& grid, const CachedResult& result) {
+        if (kind == Lookup::Validate) {
+            bool complete = std::find(grid.cells.begin(), grid.cells.end(), 0) == grid.cells.end();
+            return "OK " + std::to_string(result.solutions) + " " + (complete ? "1" : "0");
+        }
+        return result.solutions > 0 ? "OK " + result.solution.str() : "ERR no solution";
+    }
+
+    // Works out and caches the results of lookups that missed the cache, off
+    // the event loop. notify_fd() turns readable whenever a job is done.
+    class LookupWorkers {
+    public:
+        LookupWorkers(ResultCache& cache, int threads) : cache(cache) {
+            eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            for (int i = 0; i < threads; i++) {
+                workers.emplace_back(&LookupWorkers::run, this);
+            }
+        }
+
+        ~LookupWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            ready.notify_all();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            close(eventFd);
+        }
+
+        void submit(LookupJob job) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.push_back(std::move(job));
+            }
+            ready.notify_one();
+        }
+
+        std::vector<LookupJob> finished() {
+            uint64_t count;
+            while (read(eventFd, &count, sizeof(count)) == sizeof(count)) {
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            return std::exchange(done, {});
+        }
+
+        int notify_fd() const { return eventFd; }
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping) {
+                    return;
+                }
+                LookupJob job = std::move(jobs.front());
+                jobs.pop_front();
+                lock.unlock();
+                job.line = lookup_line(job.kind, job.grid, cache.compute(job.grid));
+                lock.lock();
+                done.push_back(std::move(job));
+                uint64_t one = 1;
+                (void)!write(eventFd, &one, sizeof(one));
+            }
+        }
+
+        ResultCache& cache;
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<LookupJob> jobs;
+        std::vector<LookupJob> done;
+        bool stopping = false;
+        int eventFd;
+        std::vector<std::thread> workers;
+    };
+
+    bool parse_grid(const std::string& text, Board& board) {
+        if (text.size() != 81) {
+            return false;
+        }
+        for (int i = 0; i < 81; i++) {
+            char ch = text[i];
+            if (ch == '.') {
+                ch = '0';
+            }
+            if (ch < '0' || ch > '9') {
+                return false;
+            }
+            board.cells[i] = ch - '0';
+        }
+        return true;
+    }
+
+    class Server {
+    public:
+        Server(int listenFd, PuzzlePool& pool, ResultCache& cache, int solvers)
+            : listenFd(listenFd), pool(pool), cache(cache), lookups(cache, solvers) {
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            watch(listenFd, EPOLLIN);
+            watch(pool.notify_fd(), EPOLLIN);
+            watch(lookups.notify_fd(), EPOLLIN);
+        }
+
+        ~Server() {
+            for (auto& [fd, connection] : connections) {
+                close(fd);
+            }
+            close(epollFd);
+        }
+
+        void run() {
+            auto lastReport = Clock::now();
+            long long reported = 0;
+            epoll_event events[64];
+            while (!stopRequested) {
+                int n = epoll_wait(epollFd, events, 64, 100);
+                for (int i = 0; i < n; i++) {
+                    int fd = events[i].data.fd;
+                    if (fd == listenFd) {
+                        accept_all();
+                    } else if (fd == pool.notify_fd()) {
+                        pool.drain_notifications();
+                        serve_pending();
+                    } else if (fd == lookups.notify_fd()) {
+                        serve_lookups();
+                    } else {
+                        handle(fd, events[i].events);
+                    }
+                }
+                expire_pending();
+                if (Clock::now() - lastReport >= std::chrono::seconds(10) && latencies.count() != reported) {
+                    std::cerr << "sudokurse-server: " << latencies.report() << std::endl;
+                    reported = latencies.count();
+                    lastReport = Clock::now();
+                }
+            }
+        }
+
+    private:
+        int epollFd;
+        int listenFd;
+        PuzzlePool& pool;
+        ResultCache& cache;
+        LookupWorkers lookups;
+        std::unordered_map<int, Connection> connections;
+        uint64_t nextConnection = 0;
+        std::array<std::deque<PendingGet>, difficultyCount> pending;
+        LatencyLog latencies;
+
+        void watch(int fd, uint32_t events) {
+            epoll_event ev{};
+            ev.events = events;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        }
+
+        void accept_all() {
+            while (true) {
+                int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                    return;
+                }
+                connections[fd] = Connection{fd, nextConnection++};
+                watch(fd, EPOLLIN | EPOLLRDHUP);
+            }
+        }
+
+        void drop(int fd) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            connections.erase(fd);
+            // forget queued GETs so a reused fd never receives someone else's puzzle
+            for (auto& queue : pending) {
+                std::erase_if(queue, [fd](const PendingGet& get) { return get.fd == fd; });
+            }
+        }
+
+        void handle(int fd, uint32_t events) {
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                return;
+            }
+            Connection& connection = it->second;
+            if (events & EPOLLIN) {
+                char chunk[4096];
+                ssize_t n;
+                while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+                    connection.in.append(chunk, n);
+                }
+                size_t newline;
+                while ((newline = connection.in.find('\n')) != std::string::npos) {
+                    std::string line = connection.in.substr(0, newline);
+                    connection.in.erase(0, newline + 1);
+                    if (!line.empty() && line.back() == '\r') {
+                        line.pop_back();
+                    }
+                    request(connection, line);
+                }
+                if (connection.in.size() > 65536) {
+                    drop(fd);
+                    return;
+                }
+                if (n == 0) {
+                    connection.closing = true;
+                }
+            }
+            if (events & (EPOLLHUP | EPOLLERR)) {
+                drop(fd);
+                return;
+            }
+            flush(connection);
+        }
+
+        // a reply slot for the request being read, so replies keep request order
+        uint64_t reserve(Connection& connection) {
+            connection.replies.emplace_back();
+            return connection.firstReply + connection.replies.size() - 1;
+        }
+
+        void respond(Connection& connection, uint64_t reply, const std::string& line, Clock::time_point received) {
+            connection.replies[reply - connection.firstReply] = line;
+            latencies.add(Clock::now() - received);
+            while (!connection.replies.empty() && connection.replies.front()) {
+                connection.out += *connection.replies.front();
+                connection.out += '\n';
+                connection.replies.pop_front();
+                connection.firstReply++;
+            }
+        }
+
+        // sends what the socket takes; closes the connection once a client
+        // that has stopped sending has all its replies
+        void flush(Connection& connection) {
+            while (!connection.out.empty()) {
+                ssize_t n = send(connection.fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+                if (n <= 0) {
+                    break;
+                }
+                connection.out.erase(0, n);
+            }
+            if (connection.closing && connection.replies.empty() && connection.out.empty()) {
+                drop(connection.fd);
+                return;
+            }
+            uint32_t events = (connection.closing ? 0u : static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP))
+                | (connection.out.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+            if (events != connection.watching) {
+                epoll_event ev{};
+                ev.events = events;
+                ev.data.fd = connection.fd;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &ev);
+                connection.watching = events;
+            }
+        }
+
+        std::string puzzle_line(const PooledPuzzle& entry) {
+            // clients usually VALIDATE / SOLVE what they were given, so remember it
+            Board puzzle = entry.puzzle.unpack();
+            CachedResult result;
+            result.solution = entry.solution.unpack();
+            result.solutions = 1;
+            result.difficultyLevel = entry.difficultyLevel;
+            cache.insert(puzzle, result);
+            return "OK " + puzzle.str() + " " + result.solution.str() + " " + std::to_string(entry.difficultyLevel);
+        }
+
+        void request(Connection& connection, const std::string& line) {
+            auto received = Clock::now();
+            uint64_t reply = reserve(connection);
+            auto space = line.find(' ');
+            std::string verb = line.substr(0, space);
+            std::string arg = space == std::string::npos ? "" : line.substr(space + 1);
+            Board grid;
+
+            if (verb == "GET") {
+                Difficulty d;
+                if (!parse_difficulty(arg, d)) {
+                    respond(connection, reply, "ERR unknown difficulty", received);
+                    return;
+                }
+                PooledPuzzle entry;
+                auto& queue = pending[static_cast<int>(d)];
+                if (queue.empty() && pool.take(d, entry)) {
+                    respond(connection, reply, puzzle_line(entry), received);
+                } else {
+                    queue.push_back({connection.fd, reply, received});
+                }
+            } else if ((verb == "VALIDATE" || verb == "SOLVE") && parse_grid(arg, grid)) {
+                Lookup kind = verb == "VALIDATE" ? Lookup::Validate : Lookup::Solve;
+                if (auto cached = cache.find(grid)) {
+                    respond(connection, reply, lookup_line(kind, grid, *cached), received);
+                } else {
+                    lookups.submit({connection.fd, connection.id, reply, received, kind, grid, {}});
+                }
+            } else if (verb == "STATS") {
+                std::string line = "OK " + latencies.report();
+                for (int d = 0; d < difficultyCount; d++) {
+                    line += ' ';
+                    line += difficulty_str(static_cast<Difficulty>(d)) + "="
+                        + std::to_string(pool.size(static_cast<Difficulty>(d)));
+                }
+                auto cached = cache.stats();
+                line += " cache_hits=" + std::to_string(cached.hits) + " cache_disk_hits=" + std::to_string(cached.diskHits)
+                    + " cache_misses=" + std::to_string(cached.misses) + " cache_records=" + std::to_string(cached.records);
+                respond(connection, reply, line, received);
+            } else {
+                respond(connection, reply, "ERR bad request", received);
+            }
+        }
+
+        void serve_pending() {
+            for (int d = 0; d < difficultyCount; d++) {
+                auto& queue = pending[d];
+                PooledPuzzle entry;
+                while (!queue.empty() && pool.take(static_cast<Difficulty>(d), entry)) {
+                    PendingGet get = queue.front();
+                    queue.pop_front();
+                    auto it = connections.find(get.fd);
+                    if (it != connections.end()) {
+                        respond(it->second, get.reply, puzzle_line(entry), get.received);
+                        flush(it->second);
+                    }
+                }
+            }
+        }
+
+        void serve_lookups() {
+            for (const auto& job : lookups.finished()) {
+                // the client may have gone, and its fd been reused, while the job ran
+                auto it = connections.find(job.fd);
+                if (it != connections.end() && it->second.id == job.connection) {
+                    respond(it->second, job.reply, job.line, job.received);
+                    flush(it->second);
+                }
+            }
+        }
+
+        void expire_pending() {
+            auto now = Clock::now();
+            for (auto& queue : pending) {
+                // queues are in arrival order, so the oldest are at the front
+                while (!queue.empty() && now - queue.front().received >= getTimeout) {
+                    PendingGet get = queue.front();
+                    queue.pop_front();
+                    auto it = connections.find(get.fd);
+                    if (it != connections.end()) {
+                        respond(it->second, get.reply, "ERR timeout", get.received);
+                        flush(it->second);
+                    }
+                }
+            }
+        }
+    };
+
+    std::string default_socket_path() {
+        const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+        return std::string(runtime && *runtime ? runtime : "/tmp") + "/sudokurse.sock";
+    }
+
+    // true if a server is answering on address; a socket file nothing
+    // answers on is left over from one that died and is safe to replace
+    bool socket_in_use(const sockaddr_un& address) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return false;
+        }
+        bool inUse = connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0
+            || errno == EAGAIN;     // listening, just with a full backlog
+        close(fd);
+        return inUse;
+    }
+
+    void on_signal(int) {
+        stopRequested = 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = default_socket_path();
+    size_t capacity = 32;
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    int solvers = 2;
+    std::filesystem::path cachePath = default_cache_path();
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--socket") && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--pool") && i + 1 < argc) {
+            capacity = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--solvers") && i + 1 < argc) {
+            solvers = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--cache") && i + 1 < argc) {
+            cachePath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--no-cache")) {
+            cachePath.clear();
+        } else {
+            std::cerr << "usage: sudokurse-server [--socket PATH] [--pool N] [--threads N] [--solvers N] [--cache FILE | --no-cache]" << std::endl;
+            return 2;
+        }
+    }
+
+    // same difficulty bands as the game
+    DifficultyThresholds thresholds = load_difficulty_thresholds();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "socket path too long: " << socketPath << std::endl;
+        return 1;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+    struct stat existing;
+    if (lstat(socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << socketPath << " exists and is not a socket" << std::endl;
+            return 1;
+        }
+        if (socket_in_use(address)) {
+            std::cerr << "another server is already listening on " << socketPath << std::endl;
+            return 1;
+        }
+        unlink(socketPath.c_str());
+    }
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    struct sigaction action{};
+    action.sa_handler = on_signal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::cerr << "sudokurse-server: listening on " << socketPath << " with " << threads << " generator threads" << std::endl;
+    {
+        ResultCache cache(cachePath);
+        if (!cachePath.empty() && !cache.persistent()) {
+            std::cerr << "sudokurse-server: cannot use " << cachePath << ", caching in memory only" << std::endl;
+        }
+        PuzzlePool pool(capacity, threads, thresholds);
+        Server server(listenFd, pool, cache, solvers);
+        server.run();
+    }
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "session_log.hpp"
+#include <algorithm>
+
+SessionRecorder::SessionRecorder(const std::filesystem::path& path)
+    : out(path, std::ios::binary | std::ios::trunc), started(std::chrono::steady_clock::now()) {
+    SessionHeader header;
+    header.startedAt = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    worker = std::thread(&SessionRecorder::run, this);
+}
+
+SessionRecorder::~SessionRecorder() {
+    stopping.store(true, std::memory_order_release);
+    worker.join();
+}
+
+void SessionRecorder::push(SessionEventKind kind, int cell, uint16_t value) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == SessionConstants::ringCapacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    ring[t % SessionConstants::ringCapacity] = {static_cast<uint32_t>(millis.count()), kind, static_cast<uint8_t>(cell), value};
+    tail.store(t + 1, std::memory_order_release);
+}
+
+void SessionRecorder::puzzle(const Board& givens, const Board& solution, Difficulty difficulty) {
+    push(SessionEventKind::Puzzle, 0, static_cast<uint16_t>(difficulty));
+    for (int i = 0; i < 81; i++) {
+        push(SessionEventKind::Given, i, givens.cells[i] | solution.cells[i] << 8);
+    }
+    lastGame = givens;
+    lastPencil = {};
+}
+
+void SessionRecorder::key(int ch, int row, int col) {
+    push(SessionEventKind::Key, row * 9 + col, static_cast<uint16_t>(ch));
+}
+
+void SessionRecorder::board(const Board& game, const std::array<std::array<uint16_t, 9>, 9>& pencil) {
+    for (int i = 0; i < 81; i++) {
+        if (game.cells[i] != lastGame.cells[i]) {
+            push(SessionEventKind::Set, i, game.cells[i]);
+            lastGame.cells[i] = game.cells[i];
+        }
+        uint16_t marks = pencil[i / 9][i % 9];
+        if (marks != lastPencil[i]) {
+            push(SessionEventKind::Pencil, i, marks);
+            lastPencil[i] = marks;
+        }
+    }
+}
+
+void SessionRecorder::drain() {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    while (h != t) {
+        // write up to the end of the ring in one go, then wrap
+        uint32_t begin = h % SessionConstants::ringCapacity;
+        uint32_t n = std::min(t - h, SessionConstants::ringCapacity - begin);
+        out.write(reinterpret_cast<const char*>(&ring[begin]), n * sizeof(SessionEvent));
+        h += n;
+    }
+    head.store(h, std::memory_order_release);
+
+    uint32_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost != droppedWritten) {
+        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        SessionEvent event{static_cast<uint32_t>(millis.count()), SessionEventKind::Dropped, 0,
+                           static_cast<uint16_t>(std::min<uint32_t>(lost - droppedWritten, UINT16_MAX))};
+        out.write(reinterpret_cast<const char*>(&event), sizeof(event));
+        droppedWritten = lost;
+    }
+    out.flush();
+}
+
+void SessionRecorder::run() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        drain();
+        std::this_thread::sleep_for(SessionConstants::flushInterval);
+    }
+    drain();
+}
+
+std::optional<SessionLog> read_session(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+    SessionLog log;
+    in.read(reinterpret_cast<char*>(&log.header), sizeof(log.header));
+    if (in.gcount() != sizeof(log.header)
+        || log.header.magic != SessionConstants::magic
+        || log.header.version != SessionConstants::version) {
+        return std::nullopt;
+    }
+    SessionEvent event;
+    // a partial trailing record means the game died mid-write; keep what came before it
+    while (in.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+        if (event.kind > SessionEventKind::Dropped || event.cell >= 81) {
+            return std::nullopt;
+        }
+        log.events.push_back(event);
+    }
+    return log;
+}
+
+std::vector<SessionAnalysis> analyze_session(const SessionLog& log) {
+    std::vector<SessionAnalysis> puzzles;
+    uint32_t lastSolved = 0;
+    uint32_t lastKey = 0;
+    int cursorCell = -1;
+    uint32_t cursorArrived = 0;
+
+    for (const auto& event : log.events) {
+        if (event.kind == SessionEventKind::Puzzle) {
+            SessionAnalysis analysis;
+            analysis.difficulty = static_cast<Difficulty>(event.value);
+            analysis.startedAt = event.millis;
+            puzzles.push_back(analysis);
+            lastSolved = lastKey = cursorArrived = event.millis;
+            cursorCell = -1;
+            continue;
+        }
+        // anything before the first puzzle has nothing to be measured against
+        if (puzzles.empty()) {
+            continue;
+        }
+        auto& analysis = puzzles.back();
+        analysis.endedAt = event.millis;
+
+        switch (event.kind) {
+            case SessionEventKind::Given:
+                analysis.givens.cells[event.cell] = event.value & 0xFF;
+                analysis.solution.cells[event.cell] = event.value >> 8;
+                break;
+            case SessionEventKind::Key:
+                analysis.keys++;
+                // the key before this one is what brought the cursor here
+                if (event.cell != cursorCell) {
+                    cursorCell = event.cell;
+                    cursorArrived = lastKey;
+                }
+                lastKey = event.millis;
+                break;
+            case SessionEventKind::Set: {
+                auto& cell = analysis.cells[event.cell];
+                // a resumed game logs the board it resumed from as Set events
+                // right after the puzzle, so those cells show up as instant
+                cell.entries++;
+                if (event.value != 0 && event.value == analysis.solution.cells[event.cell]) {
+                    cell.solved = true;
+                    cell.solvedAt = event.millis;
+                    cell.think = event.millis - lastSolved;
+                    cell.hesitation = event.cell == cursorCell ? event.millis - cursorArrived : 0;
+                    lastSolved = event.millis;
+                } else {
+                    cell.solved = false;
+                }
+                break;
+            }
+            case SessionEventKind::Dropped:
+                analysis.dropped += event.value;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // a puzzle counts as solved once every non-given cell holds its solution
+    for (auto& analysis : puzzles) {
+        analysis.solved = true;
+        for (int i = 0; i < 81; i++) {
+            const auto& cell = analysis.cells[i];
+            analysis.corrections += std::max(0, cell.entries - 1);
+            if (analysis.givens.cells[i] == 0 && !cell.solved) {
+                analysis.solved = false;
+            }
+        }
+    }
+    return puzzles;
+}
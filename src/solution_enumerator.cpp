@@ -0,0 +1,95 @@
+#include "solution_enumerator.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+
+Generator<Board> enumerate_solutions(Board grid) {
+    std::array<uint16_t, 9> rows{}, cols{}, boxes{};
+    std::array<uint8_t, 81> empty{};
+    int emptyCount = 0;
+
+    for (int idx = 0; idx < 81; idx++) {
+        int value = grid.cells[idx];
+        if (value == 0) {
+            empty[emptyCount++] = idx;
+            continue;
+        }
+        uint16_t bit = 1 << (value - 1);
+        if ((rows[idx / 9] | cols[idx % 9] | boxes[boxOf(idx)]) & bit) {
+            co_return;
+        }
+        rows[idx / 9] |= bit;
+        cols[idx % 9] |= bit;
+        boxes[boxOf(idx)] |= bit;
+    }
+    if (emptyCount == 0) {
+        co_yield grid;
+        co_return;
+    }
+
+    // stack[depth] holds the digits still to try in cell empty[depth]
+    std::array<uint16_t, 81> stack{};
+
+    // moves the most constrained of empty[depth..] into slot depth and returns its candidates
+    auto choose = [&](int depth) {
+        int best = depth, bestCount = 10;
+        uint16_t bestCandidates = 0;
+        for (int i = depth; i < emptyCount && bestCount > 1; i++) {
+            int idx = empty[i];
+            uint16_t candidates = allDigits & ~(rows[idx / 9] | cols[idx % 9] | boxes[boxOf(idx)]);
+            int count = std::popcount(candidates);
+            if (count < bestCount) {
+                best = i;
+                bestCount = count;
+                bestCandidates = candidates;
+            }
+        }
+        std::swap(empty[depth], empty[best]);
+        return bestCandidates;
+    };
+
+    int depth = 0;
+    stack[0] = choose(0);
+    while (depth >= 0) {
+        int idx = empty[depth];
+        int r = idx / 9, c = idx % 9, b = boxOf(idx);
+
+        // undo the digit tried last time we were at this depth
+        if (grid.cells[idx] != 0) {
+            uint16_t bit = 1 << (grid.cells[idx] - 1);
+            rows[r] &= ~bit;
+            cols[c] &= ~bit;
+            boxes[b] &= ~bit;
+            grid.cells[idx] = 0;
+        }
+        if (stack[depth] == 0) {
+            depth--;
+            continue;
+        }
+
+        uint16_t bit = stack[depth] & -stack[depth];
+        stack[depth] &= stack[depth] - 1;
+        grid.cells[idx] = std::countr_zero(bit) + 1;
+        rows[r] |= bit;
+        cols[c] |= bit;
+        boxes[b] |= bit;
+
+        if (depth + 1 == emptyCount) {
+            co_yield grid;
+            continue;
+        }
+        depth++;
+        stack[depth] = choose(depth);
+    }
+}
+
+long long count_solutions(const Board& grid, long long limit) {
+    long long count = 0;
+    for (const Board& solution : enumerate_solutions(grid)) {
+        (void)solution;
+        if (++count == limit) {
+            break;
+        }
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "solver_stats.hpp"
+#include <map>
+#include <string>
+
+SolverTrace::SolverTrace(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+std::vector<TraceRecord> SolverTrace::events() const {
+    std::vector<TraceRecord> out;
+    out.reserve(size());
+    for (size_t i = head - size(); i < head; i++) {
+        out.push_back(buffer[i & mask]);
+    }
+    return out;
+}
+
+void SolverTrace::write(std::ostream& out) const {
+    auto records = events();
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TraceRecord));
+}
+
+void SolverTrace::write_folded(std::ostream& out, int maxDepth) const {
+    // rebuild the assignment path at each node and count nodes per path;
+    // frames lost to ring buffer wrap-around show up as "?"
+    std::vector<std::string> path(256, "?");
+    std::map<std::string, long long> counts;
+    for (const auto& record : events()) {
+        switch (record.event) {
+            case TraceEvent::Assign: {
+                auto& frame = path[record.depth];
+                frame.clear();
+                frame += 'r';
+                frame += std::to_string(record.cell / 9);
+                frame += 'c';
+                frame += std::to_string(record.cell % 9);
+                frame += '=';
+                frame += std::to_string(record.digit);
+                break;
+            }
+            case TraceEvent::Enter: {
+                std::string stack = "root";
+                int depth = record.depth < maxDepth ? record.depth : maxDepth;
+                for (int d = 0; d < depth; d++) {
+                    stack += ";" + path[d];
+                }
+                counts[stack]++;
+                break;
+            }
+            case TraceEvent::Backtrack:
+            case TraceEvent::Solution:
+                break;
+        }
+    }
+    for (const auto& [stack, count] : counts) {
+        out << stack << " " << count << "\n";
+    }
+}
\ No newline at end of file
@@ -1,12 +1,11 @@
 #include "stopwatch.hpp"
 
 std::string Stopwatch::elapsed_time() const {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
+    long total = elapsed_seconds();
 
-    int hours = elapsed.count() / 3600;
-    int minutes = (elapsed.count() % 3600) / 60;
-    int seconds = elapsed.count() % 60;
+    int hours = total / 3600;
+    int minutes = (total % 3600) / 60;
+    int seconds = total % 60;
 
     std::ostringstream oss;
     oss << std::setw(2) << std::setfill('0') << hours << ":"
@@ -15,6 +14,11 @@ std::string Stopwatch::elapsed_time() const {
     return oss.str();
 }
 
-void Stopwatch::restart() {
-    start_time = std::chrono::steady_clock::now();
+long Stopwatch::elapsed_seconds() const {
+    auto now = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
+}
+
+void Stopwatch::restart(std::chrono::seconds alreadyElapsed) {
+    start_time = std::chrono::steady_clock::now() - alreadyElapsed;
 }
\ No newline at end of file
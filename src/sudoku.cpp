@@ -23,35 +23,22 @@ SOFTWARE.
  */
 
 #include "sudoku.hpp"
+#include <bit>
+#include "logic_solver.hpp"
+#include "minimal_generator.hpp"
+#include "puzzle_book.hpp"
 using namespace std;
 
 // START: Get grid as string in row major order
 string Sudoku::getGrid()
 {
-  string s = "";
-  for(int row_num=0; row_num<9; ++row_num)
-  {
-    for(int col_num=0; col_num<9; ++col_num)
-    {
-      s = s + to_string(grid[row_num][col_num]);
-    }
-  }
-
-  return s;
+  return grid.str();
 }
 // END: Get grid as string in row major order
 
 
-// START: Generate random number
-int genRandNum(int maxLimit)
-{
-  return rand()%maxLimit;
-}
-// END: Generate random number
-
-
 // START: Helper functions for solving grid
-bool FindUnassignedLocation(int grid[9][9], int &row, int &col)
+bool FindUnassignedLocation(const Board& grid, int &row, int &col)
 {
     for (row = 0; row < 9; row++)
     {
@@ -65,7 +52,7 @@ bool FindUnassignedLocation(int grid[9][9], int &row, int &col)
     return false;
 }
 
-bool UsedInRow(int grid[9][9], int row, int num)
+bool UsedInRow(const Board& grid, int row, int num)
 {
     for (int col = 0; col < 9; col++)
     {
@@ -76,7 +63,7 @@ bool UsedInRow(int grid[9][9], int row, int num)
     return false;
 }
 
-bool UsedInCol(int grid[9][9], int col, int num)
+bool UsedInCol(const Board& grid, int col, int num)
 {
     for (int row = 0; row < 9; row++)
     {
@@ -87,7 +74,7 @@ bool UsedInCol(int grid[9][9], int col, int num)
     return false;
 }
 
-bool UsedInBox(int grid[9][9], int boxStartRow, int boxStartCol, int num)
+bool UsedInBox(const Board& grid, int boxStartRow, int boxStartCol, int num)
 {
     for (int row = 0; row < 3; row++)
     {
@@ -101,7 +88,7 @@ bool UsedInBox(int grid[9][9], int boxStartRow, int boxStartCol, int num)
     return false;
 }
 
-bool isSafe(int grid[9][9], int row, int col, int num)
+bool isSafe(const Board& grid, int row, int col, int num)
 {
     return !UsedInRow(grid, row, num) && !UsedInCol(grid, col, num) && !UsedInBox(grid, row - row%3 , col - col%3, num);
 }
@@ -109,51 +96,57 @@ bool isSafe(int grid[9][9], int row, int col, int num)
 
 
 // START: Create seed grid
-void Sudoku::fillEmptyDiagonalBox(int idx)
+void Sudoku::createSeed()
 {
-  int start = idx*3;
-  random_shuffle(this->guessNum, (this->guessNum) + 9, genRandNum);
-  for (int i = 0; i < 3; ++i)
-  {
-    for (int j = 0; j < 3; ++j)
-    {
-      this->grid[start+i][start+j] = guessNum[i*3+j];
-    }
-  }
+  this->createSeed(GenBudget());
 }
 
-void Sudoku::createSeed()
+// Returns Cancelled / OutOfBudget (leaving solnGrid unset) if the budget
+// stops the search before the grid is filled.
+GenStatus Sudoku::createSeed(const GenBudget& budget)
 {
-  /* Fill diagonal boxes to form:
-      x | . | .
-      . | x | .
-      . | . | x
+  this->budget = &budget;
+  this->genStatus = GenStatus::Complete;
+  this->progress = GenProgress();
+
+  /* Fill the whole grid with a randomised search, starting over whenever a
+     run gets stuck, then pass it through a random validity-preserving
+     transform (see shuffleGrid). The old approach -- random diagonal boxes
+     completed by solveGrid in guessNum order -- strongly favoured some
+     completions over others; this one is less biased, not provably uniform.
   */
-  this->fillEmptyDiagonalBox(0);
-  this->fillEmptyDiagonalBox(1);
-  this->fillEmptyDiagonalBox(2);
-
-  /* Fill the remaining blocks:
-      x | x | x
-      x | x | x
-      x | x | x
-  */
-  this->solveGrid(); // TODO: not truly random, but still good enough because we generate random diagonals.
-
-  // Saving the solution grid
-  for(int i=0;i<9;i++)
+  bool solved = false;
+  while(!solved && this->genStatus == GenStatus::Complete)
   {
-    for(int j=0;j<9;j++)
-    {
-      this->solnGrid[i][j] = this->grid[i][j];
-    }
+    this->grid = Board();
+    std::array<uint16_t, 27> used{};
+    int deadEnds = 0;
+    solved = this->fillRandomGrid(used, deadEnds);
   }
+  this->budget = nullptr;
+  if(!solved)
+  {
+    return this->genStatus == GenStatus::Complete ? GenStatus::OutOfBudget : this->genStatus;
+  }
+  this->shuffleGrid();
+
+  // Saving the solution grid
+  this->solnGrid = this->grid;
+
+  return GenStatus::Complete;
 }
 // END: Create seed grid
 
 
 // START: Intialising
-Sudoku::Sudoku()
+Sudoku::Sudoku() : Sudoku(random_device()())
+{
+}
+
+// Every random choice (removal order, guess order, seed search and shuffle) comes from
+// this instance's generator, so equal seeds give equal puzzles and instances
+// on different threads never share state.
+Sudoku::Sudoku(uint64_t seed) : rng(seed)
 {
 
   // initialize difficulty level
@@ -165,7 +158,7 @@ Sudoku::Sudoku()
     this->gridPos[i] = i;
   }
 
-  random_shuffle(this->gridPos, (this->gridPos) + 81, genRandNum);
+  shuffle(this->gridPos, (this->gridPos) + 81, this->rng);
 
   // Randomly shuffling the guessing number array
   for(int i=0;i<9;i++)
@@ -173,16 +166,10 @@ Sudoku::Sudoku()
     this->guessNum[i]=i+1;
   }
 
-  random_shuffle(this->guessNum, (this->guessNum) + 9, genRandNum);
+  shuffle(this->guessNum, (this->guessNum) + 9, this->rng);
 
   // Initialising the grid
-  for(int i=0;i<9;i++)
-  {
-    for(int j=0;j<9;j++)
-    {
-      this->grid[i][j]=0;
-    }
-  }
+  this->grid = Board();
 
   grid_status = true;
 }
@@ -190,7 +177,7 @@ Sudoku::Sudoku()
 
 
 // START: Custom Initialising with grid passed as argument
-Sudoku::Sudoku(string grid_str, bool row_major)
+Sudoku::Sudoku(string grid_str, bool row_major) : rng(random_device()())
 {
   if(grid_str.length() != 81)
   {
@@ -266,7 +253,7 @@ Sudoku::Sudoku(string grid_str, bool row_major)
     this->guessNum[i]=i+1;
   }
 
-  random_shuffle(this->guessNum, (this->guessNum) + 9, genRandNum);
+  shuffle(this->guessNum, (this->guessNum) + 9, this->rng);
 
   grid_status = true;
 }
@@ -291,7 +278,7 @@ void Sudoku::printGrid()
       if(grid[i][j] == 0)
 	cout<<".";
       else
-	cout<<grid[i][j];
+	cout<<int(grid[i][j]);
       cout<<"|";
     }
     cout<<endl;
@@ -303,30 +290,96 @@ void Sudoku::printGrid()
 // END: Printing the grid
 
 
+// START: Solver instrumentation
+namespace
+{
+  // Adds the wall time of a top-level (depth 0) call to stats.
+  struct StatsTimer
+  {
+    SolverStats* stats;
+    chrono::steady_clock::time_point start;
+
+    StatsTimer(SolverStats* s, bool topLevel) : stats(topLevel ? s : nullptr)
+    {
+      if(stats) start = chrono::steady_clock::now();
+    }
+    ~StatsTimer()
+    {
+      if(stats) stats->wallTime += chrono::steady_clock::now() - start;
+    }
+  };
+}
+
+// row == 9 means the grid is full, i.e. this node is a solution
+void Sudoku::recordNode(int row, int col)
+{
+  if(this->stats)
+  {
+    this->stats->nodes++;
+    this->stats->maxDepth = max(this->stats->maxDepth, this->searchDepth);
+  }
+  if(this->trace)
+  {
+    uint32_t node = static_cast<uint32_t>(this->progress.nodes);
+    if(row < 9)
+      this->trace->record(node, TraceEvent::Enter, this->searchDepth, row*9 + col);
+    else
+      this->trace->record(node, TraceEvent::Solution, this->searchDepth);
+  }
+}
+
+void Sudoku::recordAssign(int row, int col, int num)
+{
+  if(this->trace)
+    this->trace->record(static_cast<uint32_t>(this->progress.nodes), TraceEvent::Assign, this->searchDepth, row*9 + col, num);
+}
+
+void Sudoku::recordBacktrack(int row, int col, int num)
+{
+  if(this->stats)
+    this->stats->backtracks++;
+  if(this->trace)
+    this->trace->record(static_cast<uint32_t>(this->progress.nodes), TraceEvent::Backtrack, this->searchDepth, row*9 + col, num);
+}
+// END: Solver instrumentation
+
+
 // START: Modified Sudoku solver
 bool Sudoku::solveGrid()
 {
     int row, col;
+    StatsTimer timer(this->stats, this->searchDepth == 0);
+
+    if (visitNode())
+       return false; // out of budget, unwind
 
     // If there is no unassigned location, we are done
-    if (!FindUnassignedLocation(this->grid, row, col))
+    bool done = !FindUnassignedLocation(this->grid, row, col);
+    recordNode(row, col);
+    if (done)
        return true; // success!
 
     // Consider digits 1 to 9
     for (int num = 0; num < 9; num++)
     {
         // if looks promising
+        if (this->stats) this->stats->candidateChecks++;
         if (isSafe(this->grid, row, col, this->guessNum[num]))
         {
             // make tentative assignment
             this->grid[row][col] = this->guessNum[num];
+            recordAssign(row, col, this->guessNum[num]);
 
             // return, if success, yay!
-            if (solveGrid())
+            this->searchDepth++;
+            bool solved = solveGrid();
+            this->searchDepth--;
+            if (solved)
                 return true;
 
             // failure, unmake & try again
             this->grid[row][col] = UNASSIGNED;
+            recordBacktrack(row, col, this->guessNum[num]);
         }
     }
 
@@ -336,12 +389,142 @@ bool Sudoku::solveGrid()
 // END: Modified Sudoku Solver
 
 
+// START: Random grid sampling
+// Randomised search for a complete grid. `used` holds the digits already in
+// each row (0-8), column (9-17) and box (18-26). Always branches on the cell
+// with the fewest candidates, ties broken at random, and tries its digits in
+// random order, so every completion stays reachable. Gives up after
+// SEED_RESTART_LIMIT dead ends so createSeed can start over rather than dig out
+// of a bad early choice.
+bool Sudoku::fillRandomGrid(std::array<uint16_t, 27>& used, int& deadEnds)
+{
+  StatsTimer timer(this->stats, this->searchDepth == 0);
+
+  if(visitNode())
+    return false; // out of budget, unwind
+
+  int best = -1, bestCount = 10, ties = 0;
+  uint16_t bestMask = 0;
+  for(int idx = 0; idx < 81 && bestCount > 0; idx++)
+  {
+    if(this->grid.cells[idx] != UNASSIGNED)
+      continue;
+    int row = idx / 9, col = idx % 9;
+    uint16_t mask = allDigits & ~(used[row] | used[9 + col] | used[18 + (row/3)*3 + col/3]);
+    int count = popcount(mask);
+    // reservoir sampling keeps a uniformly random one of the tied cells
+    if(count < bestCount)
+    {
+      best = idx;
+      bestCount = count;
+      bestMask = mask;
+      ties = 1;
+    }
+    else if(count == bestCount && uniform_int_distribution<int>(0, ties++)(this->rng) == 0)
+    {
+      best = idx;
+      bestMask = mask;
+    }
+  }
+  recordNode(best < 0 ? 9 : best / 9, best < 0 ? 0 : best % 9);
+  if(best < 0)
+    return true; // every cell filled
+  if(bestCount == 0)
+  {
+    deadEnds++;
+    return false;
+  }
+
+  uint8_t digits[9];
+  int n = 0;
+  for(int num = 1; num <= 9; num++)
+  {
+    if(bestMask & (1 << (num - 1)))
+      digits[n++] = num;
+  }
+  shuffle(digits, digits + n, this->rng);
+
+  int row = best / 9, col = best % 9, box = (row/3)*3 + col/3;
+  for(int i = 0; i < n; i++)
+  {
+    uint16_t bit = 1 << (digits[i] - 1);
+    this->grid.cells[best] = digits[i];
+    used[row] |= bit;
+    used[9 + col] |= bit;
+    used[18 + box] |= bit;
+    recordAssign(row, col, digits[i]);
+
+    this->searchDepth++;
+    bool solved = fillRandomGrid(used, deadEnds);
+    this->searchDepth--;
+    if(solved)
+      return true;
+
+    this->grid.cells[best] = UNASSIGNED;
+    used[row] &= ~bit;
+    used[9 + col] &= ~bit;
+    used[18 + box] &= ~bit;
+    recordBacktrack(row, col, digits[i]);
+    if(deadEnds > SEED_RESTART_LIMIT || this->genStatus != GenStatus::Complete)
+      return false;
+  }
+  return false;
+}
+
+// Applies a random member of the grid's symmetry group: relabel the digits,
+// permute the bands and the rows within each band, the stacks and the
+// columns within each stack, and transpose half the time. Each of these
+// keeps a valid grid valid, and together they move a grid to a uniformly
+// random point of its equivalence class (up to about 1.2 x 10^12 grids).
+// That only spreads the result evenly within the class the search landed
+// in; how often the search lands in each of the ~5.5 x 10^9 classes is up
+// to fillRandomGrid, and is not known to be uniform.
+void Sudoku::shuffleGrid()
+{
+  uint8_t digits[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  shuffle(digits + 1, digits + 10, this->rng);
+
+  int rowMap[9], colMap[9];
+  for(int* map : {rowMap, colMap})
+  {
+    int bands[3] = {0, 1, 2};
+    shuffle(bands, bands + 3, this->rng);
+    for(int band = 0; band < 3; band++)
+    {
+      int lines[3] = {0, 1, 2};
+      shuffle(lines, lines + 3, this->rng);
+      for(int line = 0; line < 3; line++)
+        map[band*3 + line] = bands[band]*3 + lines[line];
+    }
+  }
+  bool transpose = uniform_int_distribution<int>(0, 1)(this->rng);
+
+  Board shuffled;
+  for(int row = 0; row < 9; row++)
+  {
+    for(int col = 0; col < 9; col++)
+    {
+      int value = transpose ? this->grid[colMap[col]][rowMap[row]] : this->grid[rowMap[row]][colMap[col]];
+      shuffled[row][col] = digits[value];
+    }
+  }
+  this->grid = shuffled;
+}
+// END: Random grid sampling
+
+
 // START: Check if the grid is uniquely solvable
 void Sudoku::countSoln(int &number)
 {
   int row, col;
+  StatsTimer timer(this->stats, this->searchDepth == 0);
+
+  if(visitNode())
+    return ;
 
-  if(!FindUnassignedLocation(this->grid, row, col))
+  bool done = !FindUnassignedLocation(this->grid, row, col);
+  recordNode(row, col);
+  if(done)
   {
     number++;
     return ;
@@ -350,10 +533,15 @@ void Sudoku::countSoln(int &number)
 
   for(int i=0;i<9 && number<2;i++)
   {
+      if(this->stats) this->stats->candidateChecks++;
       if( isSafe(this->grid, row, col, this->guessNum[i]) )
       {
         this->grid[row][col] = this->guessNum[i];
+        recordAssign(row, col, this->guessNum[i]);
+        this->searchDepth++;
         countSoln(number);
+        this->searchDepth--;
+        recordBacktrack(row, col, this->guessNum[i]);
       }
 
       this->grid[row][col] = UNASSIGNED;
@@ -363,148 +551,142 @@ void Sudoku::countSoln(int &number)
 // END: Check if the grid is uniquely solvable
 
 
+// START: Lazily enumerate every solution of the grid
+// Unlike countSoln this is not capped at two; see solution_enumerator.hpp.
+Generator<Board> Sudoku::solutions() const
+{
+  return enumerate_solutions(this->grid);
+}
+// END: Lazily enumerate every solution of the grid
+
+
 // START: Gneerate puzzle
 void Sudoku::genPuzzle()
 {
-  for(int i=0;i<81;i++)
+  this->genPuzzle(GenBudget());
+}
+
+// Stops early when the budget runs out or is cancelled. Every clue is only
+// removed once uniqueness is confirmed, so the grid is always a valid
+// puzzle -- the best one found so far, just with extra clues.
+GenStatus Sudoku::genPuzzle(const GenBudget& budget)
+{
+  this->budget = &budget;
+  this->genStatus = GenStatus::Complete;
+  this->progress = GenProgress();
+
+  for(int i=0;i<81 && this->genStatus==GenStatus::Complete;i++)
   {
     int x = (this->gridPos[i])/9;
     int y = (this->gridPos[i])%9;
     int temp = this->grid[x][y];
     this->grid[x][y] = UNASSIGNED;
 
-    // If now more than 1 solution , replace the removed cell back.
+    // If now more than 1 solution (or we gave up counting), replace the removed cell back.
     int check=0;
     countSoln(check);
-    if(check!=1)
+    if(check!=1 || this->genStatus!=GenStatus::Complete)
     {
       this->grid[x][y] = temp;
     }
+    else
+    {
+      this->progress.cluesRemoved++;
+    }
+
+    this->progress.positionsTried++;
+    if(budget.onProgress)
+      budget.onProgress(this->progress);
+    checkBudget();
   }
+
+  this->budget = nullptr;
+  return this->genStatus;
 }
 // END: Generate puzzle
 
 
-// START: Printing into SVG file
-void Sudoku::printSVG(string path="")
+// START: Generate minimal puzzle
+// Replaces grid with a minimal puzzle for solnGrid (so call createSeed first),
+// searching removal orders in parallel -- see minimal_generator.hpp.
+GenStatus Sudoku::genMinimalPuzzle(const MinimalOptions& options, const GenBudget& budget)
 {
-  string fileName = path + "svgHead.txt";
-  ifstream file1(fileName.c_str());
-  stringstream svgHead;
-  svgHead << file1.rdbuf();
-
-  ofstream outFile("puzzle.svg");
-  outFile << svgHead.rdbuf();
-
-  for(int i=0;i<9;i++)
-  {
-    for(int j=0;j<9;j++)
-    {
-      if(this->grid[i][j]!=0)
-      {
-        int x = 50*j + 16;
-        int y = 50*i + 35;
-
-        stringstream text;
-        text<<"<text x=\""<<x<<"\" y=\""<<y<<"\" style=\"font-weight:bold\" font-size=\"30px\">"<<this->grid[i][j]<<"</text>\n";
-
-        outFile << text.rdbuf();
-      }
-    }
-  }
-
-    outFile << "<text x=\"50\" y=\"500\" style=\"font-weight:bold\" font-size=\"15px\">Difficulty Level (0 being easiest): "                  <<this->difficultyLevel<<"</text>\n";
-    outFile << "</svg>";
-
+  MinimalResult result = generate_minimal(this->solnGrid, options, budget);
+  this->grid = result.puzzle;
+  this->progress = GenProgress();
+  this->progress.cluesRemoved = 81 - result.clues;
+  this->progress.positionsTried = result.attempts;
+  return result.status;
 }
-// END: Printing into SVG file
+// END: Generate minimal puzzle
 
 
-// START: Calculate branch difficulty score
-int Sudoku::branchDifficultyScore()
+// START: Generation budget
+// Counts a search node; returns true once the search should unwind.
+bool Sudoku::visitNode()
 {
-   int emptyPositions = -1;
-   int tempGrid[9][9];
-   int sum=0;
+  this->progress.nodes++;
+  if(this->budget == nullptr)
+    return false;
+
+  if(this->genStatus != GenStatus::Complete)
+    return true;
 
-   for(int i=0;i<9;i++)
+  if(this->budget->maxNodes > 0 && this->progress.nodes >= this->budget->maxNodes)
   {
-    for(int j=0;j<9;j++)
-    {
-      tempGrid[i][j] = this->grid[i][j];
-    }
+    this->genStatus = GenStatus::OutOfBudget;
+    return true;
   }
 
-   while(emptyPositions!=0)
-   {
-     vector<vector<int> > empty; 
-
-     for(int i=0;i<81;i++)
-     {
-        if(tempGrid[(int)(i/9)][(int)(i%9)] == 0)
-        {
-       	  vector<int> temp;
-	  temp.push_back(i);
-	
-	  for(int num=1;num<=9;num++)
-	  {
-	    if(isSafe(tempGrid,i/9,i%9,num))
-	    {
-	      temp.push_back(num);
-	    }
-	  }
-
-	  empty.push_back(temp);
-        }
-      
-     }
-
-     if(empty.size() == 0)
-     { 
-       cout<<"Hello: "<<sum<<endl;
-       return sum;
-     } 
-
-     int minIndex = 0;
-
-     int check = empty.size();
-     for(int i=0;i<check;i++)
-     {
-       if(empty[i].size() < empty[minIndex].size())
-	  minIndex = i;
-     }
+  if((this->progress.nodes & 4095) == 0)
+  {
+    if(this->budget->onProgress)
+      this->budget->onProgress(this->progress);
+    return checkBudget();
+  }
+  return false;
+}
 
-     int branchFactor=empty[minIndex].size();
-     int rowIndex = empty[minIndex][0]/9;
-     int colIndex = empty[minIndex][0]%9;
+// Polls cancellation and the deadline; returns true if either has tripped.
+bool Sudoku::checkBudget()
+{
+  if(this->budget == nullptr || this->genStatus != GenStatus::Complete)
+    return this->genStatus != GenStatus::Complete;
 
-     tempGrid[rowIndex][colIndex] = this->solnGrid[rowIndex][colIndex];
-     sum = sum + ((branchFactor-2) * (branchFactor-2)) ;
+  if(this->budget->cancel != nullptr && this->budget->cancel->cancelled())
+    this->genStatus = GenStatus::Cancelled;
+  else if(std::chrono::steady_clock::now() >= this->budget->deadline)
+    this->genStatus = GenStatus::OutOfBudget;
 
-     emptyPositions = empty.size() - 1;
-   }
+  return this->genStatus != GenStatus::Complete;
+}
+// END: Generation budget
 
-   return sum;
 
+// START: Printing into SVG file
+// A one-puzzle book; to export many puzzles use PuzzleBook directly so the
+// template is read once and everything goes through one stream.
+void Sudoku::printSVG(string path="")
+{
+  ofstream outFile("puzzle.svg");
+  BookOptions options;
+  options.perPage = 1;
+  options.columns = 1;
+  options.templatePath = path;
+  options.expectedPuzzles = 1;
+
+  PuzzleBook book(outFile, options);
+  book.add(this->grid, this->difficultyLevel);
 }
-// END: Finish branch difficulty score
+// END: Printing into SVG file
 
 
 // START: Calculate difficulty level of current grid
+// Graded by the human techniques the grid needs and, when they are not
+// enough, by how much of the grid they leave (see logic_solver.hpp).
 void Sudoku::calculateDifficulty()
 {
-  int B = branchDifficultyScore();
-  int emptyCells = 0;
-
-  for(int i=0;i<9;i++)
-  {
-    for(int j=0;j<9;j++)
-    {
-	if(this->grid[i][j] == 0)
-	   emptyCells++;
-    }
-  } 
-
-  this->difficultyLevel = B*100 + emptyCells;
+  LogicSolver solver(this->grid, this->stats);
+  this->difficultyLevel = solver.solve().score;
 }
 // END: calculating difficulty level
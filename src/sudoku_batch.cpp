@@ -0,0 +1,79 @@
+#include "sudoku_batch.hpp"
+#include <algorithm>
+#include "bit_solver.hpp"
+#include "logic_solver.hpp"
+#include "result_cache.hpp"
+#include "solution_enumerator.hpp"
+#include "sudoku.hpp"
+
+bool solve_batch(std::span<const Board> puzzles, std::span<Board> solutions, std::span<uint8_t> solved,
+                 ResultCache* cache) {
+    if (solutions.size() < puzzles.size() || (!solved.empty() && solved.size() < puzzles.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        bool ok;
+        if (cache != nullptr) {
+            // the cache keeps BitSolver's first solution, so both paths agree
+            auto result = cache->get(puzzles[i]);
+            ok = result.solutions > 0;
+            solutions[i] = result.solution;
+        } else {
+            ok = BitSolver(puzzles[i]).solve(solutions[i]);
+        }
+        if (!ok) {
+            solutions[i] = Board();
+        }
+        if (!solved.empty()) {
+            solved[i] = ok;
+        }
+    }
+    return true;
+}
+
+bool count_batch(std::span<const Board> puzzles, int limit, std::span<int> counts, ResultCache* cache) {
+    if (counts.size() < puzzles.size()) {
+        return false;
+    }
+    bool countAll = limit <= 0 || limit > maxSolutionCount;
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        if (cache != nullptr && !countAll && limit <= 2) {
+            counts[i] = std::min(cache->get(puzzles[i]).solutions, limit);
+            continue;
+        }
+        // BitSolver is fastest for the usual "unique?" question, the enumerator for long counts
+        counts[i] = countAll ? static_cast<int>(count_solutions(puzzles[i], maxSolutionCount))
+                             : BitSolver(puzzles[i]).count(limit);
+    }
+    return true;
+}
+
+bool grade_batch(std::span<const Board> puzzles, std::span<int> scores, ResultCache* cache) {
+    if (scores.size() < puzzles.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        scores[i] = cache != nullptr ? cache->get(puzzles[i]).difficultyLevel : LogicSolver(puzzles[i]).solve().score;
+    }
+    return true;
+}
+
+bool generate_batch(uint64_t seed, std::span<Board> puzzles, std::span<Board> solutions, std::span<int> scores) {
+    if ((!solutions.empty() && solutions.size() < puzzles.size()) || (!scores.empty() && scores.size() < puzzles.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        Sudoku generator(seed + i);
+        generator.createSeed();
+        generator.genPuzzle();
+        puzzles[i] = generator.grid;
+        if (!solutions.empty()) {
+            solutions[i] = generator.solnGrid;
+        }
+        if (!scores.empty()) {
+            generator.calculateDifficulty();
+            scores[i] = generator.difficultyLevel;
+        }
+    }
+    return true;
+}
\ No newline at end of file
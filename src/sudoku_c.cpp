@@ -0,0 +1,71 @@
+#include "sudoku_c.h"
+#include <algorithm>
+#include <cstring>
+#include "sudoku_batch.hpp"
+
+static_assert(SUDOKU_COUNT_MAX == maxSolutionCount);
+
+namespace {
+    // copies grid i of a packed batch into a Board; false if it holds bytes outside 0..9
+    bool load(const uint8_t* grids, size_t i, Board& board) {
+        std::memcpy(board.cells.data(), grids + i * SUDOKU_GRID_SIZE, SUDOKU_GRID_SIZE);
+        return std::all_of(board.cells.begin(), board.cells.end(), [](uint8_t v) { return v <= 9; });
+    }
+
+    void store(const Board& board, uint8_t* grids, size_t i) {
+        std::memcpy(grids + i * SUDOKU_GRID_SIZE, board.cells.data(), SUDOKU_GRID_SIZE);
+    }
+}
+
+extern "C" {
+
+size_t sudoku_solve(const uint8_t* puzzles, uint8_t* solutions, size_t n) {
+    size_t solvedCount = 0;
+    for (size_t i = 0; i < n; i++) {
+        Board puzzle, solution;
+        uint8_t solved = 0;
+        if (load(puzzles, i, puzzle)) {
+            solve_batch({&puzzle, 1}, {&solution, 1}, {&solved, 1});
+        }
+        store(solution, solutions, i);
+        solvedCount += solved;
+    }
+    return solvedCount;
+}
+
+void sudoku_count(const uint8_t* puzzles, int limit, int* counts, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        Board puzzle;
+        counts[i] = 0;
+        if (load(puzzles, i, puzzle)) {
+            count_batch({&puzzle, 1}, limit, {counts + i, 1});
+        }
+    }
+}
+
+void sudoku_grade(const uint8_t* puzzles, int* scores, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        Board puzzle;
+        scores[i] = -1;
+        if (load(puzzles, i, puzzle)) {
+            grade_batch({&puzzle, 1}, {scores + i, 1});
+        }
+    }
+}
+
+void sudoku_generate(uint64_t seed, uint8_t* puzzles, uint8_t* solutions, int* scores, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        Board puzzle, solution;
+        int score = 0;
+        generate_batch(seed + i, {&puzzle, 1}, {&solution, 1}, {&score, 1});
+        store(puzzle, puzzles, i);
+        if (solutions != nullptr) {
+            store(solution, solutions, i);
+        }
+        if (scores != nullptr) {
+            scores[i] = score;
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,280 @@
+// Differential verification runner: feeds random seed grids and generated
+// puzzles through every solver backend, checks they agree with the reference
+// Sudoku implementation, and prints per-backend solve / count / grade
+// throughput. Grading has one implementation (LogicSolver), so the grade
+// check only confirms the C API and the cached batch path reach it unchanged.
+// Each seed also gets a minimal puzzle, whose minimal flag is checked
+// against is_minimal().
+//
+// usage: sudokurse-verify [puzzles=100] [first-seed=1]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bit_solver.hpp"
+#include "minimal_generator.hpp"
+#include "result_cache.hpp"
+#include "solution_enumerator.hpp"
+#include "sudoku.hpp"
+#include "sudoku_batch.hpp"
+#include "sudoku_c.h"
+
+namespace {
+    enum Operation { Solve, Count, Grade, operationCount };
+
+    struct Timing {
+        std::chrono::nanoseconds time{0};
+        long long calls = 0;
+    };
+
+    struct Backend {
+        std::string name;
+        std::function<bool(const Board&, Board&)> solve;
+        std::function<int(const Board&)> count;      // solutions, capped at 2
+        std::function<int(const Board&)> grade;      // empty if the backend cannot grade
+        std::array<Timing, operationCount> timings{};   // kept per operation so calls/s compare like with like
+    };
+
+    Sudoku load(const Board& grid) {
+        Sudoku s(1);    // fixed seed keeps the reference's guess order reproducible
+        s.grid = grid;
+        return s;
+    }
+
+    std::vector<Backend> backends() {
+        std::vector<Backend> all;
+        all.push_back({
+            "reference",
+            [](const Board& in, Board& out) {
+                auto s = load(in);
+                bool ok = s.solveGrid();
+                out = s.grid;
+                return ok;
+            },
+            [](const Board& in) {
+                auto s = load(in);
+                int n = 0;
+                s.countSoln(n);
+                return n;
+            },
+            [](const Board& in) {
+                auto s = load(in);
+                s.calculateDifficulty();
+                return s.difficultyLevel;
+            },
+        });
+        all.push_back({
+            "bitmask",
+            [](const Board& in, Board& out) { return BitSolver(in).solve(out); },
+            [](const Board& in) { return BitSolver(in).count(2); },
+            nullptr,
+        });
+        all.push_back({
+            "enumerator",
+            [](const Board& in, Board& out) {
+                auto solutions = enumerate_solutions(in);
+                const Board* first = solutions.next();
+                if (first) {
+                    out = *first;
+                }
+                return first != nullptr;
+            },
+            [](const Board& in) { return static_cast<int>(count_solutions(in, 2)); },
+            nullptr,
+        });
+        // the C ABI over the batch entry points, one grid per call
+        all.push_back({
+            "c-api",
+            [](const Board& in, Board& out) { return sudoku_solve(in.cells.data(), out.cells.data(), 1) == 1; },
+            [](const Board& in) {
+                int n = 0;
+                sudoku_count(in.cells.data(), 2, &n, 1);
+                return n;
+            },
+            [](const Board& in) {
+                int score = 0;
+                sudoku_grade(in.cells.data(), &score, 1);
+                return score;
+            },
+        });
+        // batch entry points through an in-memory ResultCache: the solve misses, count and grade hit
+        static ResultCache cache;
+        all.push_back({
+            "cached",
+            [](const Board& in, Board& out) {
+                uint8_t solved = 0;
+                solve_batch({&in, 1}, {&out, 1}, {&solved, 1}, &cache);
+                return solved == 1;
+            },
+            [](const Board& in) {
+                int n = 0;
+                count_batch({&in, 1}, 2, {&n, 1}, &cache);
+                return n;
+            },
+            [](const Board& in) {
+                int score = 0;
+                grade_batch({&in, 1}, {&score, 1}, &cache);
+                return score;
+            },
+        });
+        return all;
+    }
+
+    // three random diagonal boxes and nothing else: valid, with a huge number of solutions
+    Board diagonal_boxes(unsigned seed) {
+        std::minstd_rand rng(seed);
+        std::array<uint8_t, 9> digits{1, 2, 3, 4, 5, 6, 7, 8, 9};
+        Board grid;
+        for (int box = 0; box < 3; box++) {
+            std::shuffle(digits.begin(), digits.end(), rng);
+            for (int i = 0; i < 9; i++) {
+                grid[box * 3 + i / 3][box * 3 + i % 3] = digits[i];
+            }
+        }
+        return grid;
+    }
+
+    // generate_minimal's claims about its result, checked from scratch; empty if they hold
+    std::string check_minimal(const MinimalResult& result, const Board& solution) {
+        Board solved;
+        if (BitSolver(result.puzzle).count(2) != 1 || !BitSolver(result.puzzle).solve(solved) || solved != solution) {
+            return "minimal generator: puzzle does not have exactly its grid as solution";
+        }
+        if (!result.symmetric) {
+            return "minimal generator: clue pattern lost the requested symmetry";
+        }
+        if (result.minimal != is_minimal(result.puzzle)) {
+            return result.minimal ? "minimal generator: claims minimal, is_minimal() finds a removable clue"
+                                  : "minimal generator: claims not minimal, is_minimal() disagrees";
+        }
+        return {};
+    }
+
+    // out is a complete valid grid that keeps every given of in
+    bool completes(const Board& in, const Board& out) {
+        for (int r = 0; r < 9; r++) {
+            for (int c = 0; c < 9; c++) {
+                if (out[r][c] < 1 || out[r][c] > 9) {
+                    return false;
+                }
+                if (in[r][c] != 0 && in[r][c] != out[r][c]) {
+                    return false;
+                }
+            }
+        }
+        return BitSolver(out).valid();
+    }
+
+    template <typename F>
+    auto timed(Backend& backend, Operation op, F&& f) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        backend.timings[op].time += std::chrono::steady_clock::now() - start;
+        backend.timings[op].calls++;
+        return result;
+    }
+
+    // runs one input through every backend; returns an empty string or a description of the first mismatch
+    std::string check(std::vector<Backend>& all, const Board& input) {
+        Backend& ref = all[0];
+        Board refSolution;
+        bool refSolved = timed(ref, Solve, [&] { return ref.solve(input, refSolution); });
+        int refCount = timed(ref, Count, [&] { return ref.count(input); });
+        int refGrade = timed(ref, Grade, [&] { return ref.grade(input); });
+        if (refSolved && !completes(input, refSolution)) {
+            return "reference returned an invalid solution";
+        }
+
+        for (size_t i = 1; i < all.size(); i++) {
+            Backend& backend = all[i];
+            Board solution;
+            bool solved = timed(backend, Solve, [&] { return backend.solve(input, solution); });
+            int count = timed(backend, Count, [&] { return backend.count(input); });
+
+            if (solved != refSolved) {
+                return backend.name + " solved=" + std::to_string(solved) + ", reference solved=" + std::to_string(refSolved);
+            }
+            if (solved && !completes(input, solution)) {
+                return backend.name + " returned an invalid solution " + solution.str();
+            }
+            // with several solutions each backend may legitimately find a different one
+            if (solved && refCount == 1 && solution != refSolution) {
+                return backend.name + " solution " + solution.str() + " != reference " + refSolution.str();
+            }
+            if (count != refCount) {
+                return backend.name + " count=" + std::to_string(count) + ", reference count=" + std::to_string(refCount);
+            }
+            if (backend.grade) {
+                int grade = timed(backend, Grade, [&] { return backend.grade(input); });
+                if (grade != refGrade) {
+                    return backend.name + " difficulty=" + std::to_string(grade) + ", reference difficulty=" + std::to_string(refGrade);
+                }
+            }
+        }
+        return "";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int puzzles = argc > 1 ? std::atoi(argv[1]) : 100;
+    unsigned firstSeed = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1;
+    auto all = backends();
+
+    for (int i = 0; i < puzzles; i++) {
+        unsigned seed = firstSeed + i;
+
+        // a seed grid with many solutions and a generated puzzle
+        Board seedGrid = diagonal_boxes(seed);
+        Sudoku generator(seed);
+        generator.createSeed();
+        generator.genPuzzle();
+        Board puzzle = generator.grid;
+
+        // and a minimal one for the same grid, cycling through the symmetries
+        MinimalOptions options;
+        options.symmetry = static_cast<Symmetry>(seed % 4);
+        options.attempts = 8;
+        options.seed = seed;
+        MinimalResult minimal = generate_minimal(generator.solnGrid, options);
+        if (auto problem = check_minimal(minimal, generator.solnGrid); !problem.empty()) {
+            std::cerr << "MISMATCH (reproduce with: sudokurse-verify 1 " << seed << ")\n"
+                      << "  input " << minimal.puzzle.str() << "\n"
+                      << "  " << problem << std::endl;
+            return 1;
+        }
+
+        for (const Board* input : {&seedGrid, &puzzle, &minimal.puzzle}) {
+            auto mismatch = check(all, *input);
+            if (!mismatch.empty()) {
+                std::cerr << "MISMATCH (reproduce with: sudokurse-verify 1 " << seed << ")\n"
+                          << "  input " << input->str() << "\n"
+                          << "  " << mismatch << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::cout << "all " << all.size() << " backends agree on " << puzzles * 3 << " grids (seeds "
+              << firstSeed << ".." << firstSeed + puzzles - 1 << ")\n\n";
+    std::cout << std::left << std::setw(12) << "backend" << std::right
+              << std::setw(14) << "solve/s" << std::setw(14) << "count/s" << std::setw(14) << "grade/s" << "\n";
+    for (const auto& backend : all) {
+        std::cout << std::left << std::setw(12) << backend.name << std::right;
+        for (const auto& timing : backend.timings) {
+            double seconds = std::chrono::duration<double>(timing.time).count();
+            if (timing.calls == 0 || seconds <= 0) {
+                std::cout << std::setw(14) << "-";
+            } else {
+                std::cout << std::setw(14) << std::fixed << std::setprecision(0) << timing.calls / seconds;
+            }
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}